@@ -0,0 +1,150 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// forward declarations, see end of file
+typedef struct arena Arena;
+typedef struct arena_block ArenaBlock;
+
+/*
+ * Arena: a bump allocator for short-lived allocations, e.g. everything that
+ * is needed while parsing one message.
+ *
+ * Allocating only moves a pointer forward. Nothing is freed individually:
+ * arena_reset() frees everything at once in O(1), and arena_save() /
+ * arena_restore() free everything allocated after a marker.
+ *
+ * Memory comes in blocks. Blocks are either provided by the caller
+ * (arena_init(), arena_add_block()), or on Linux mmap'd on demand
+ * (arena_init_mmap()). Blocks are chained: when a block is full, the
+ * allocation continues in the next one. Blocks are kept after a reset or
+ * restore, so a steady state workload does not map or unmap anything.
+ *
+ * Usage:
+ *  static uint8_t memory[4096];
+ *  Arena arena;
+ *  arena_init(&arena, memory, sizeof(memory));
+ *  for(;;) {
+ *      Message *msg = arena_alloc(&arena, sizeof(Message), 4);
+ *      parse(&arena, msg);
+ *      handle(msg);
+ *      arena_reset(&arena);
+ *  }
+ */
+
+#if defined(__linux__)
+#define ARENA_HAS_MMAP  (1)
+#else
+#define ARENA_HAS_MMAP  (0)
+#endif
+
+/*
+ * Position in an arena, see arena_save().
+ */
+typedef struct {
+    ArenaBlock *block;
+    char *pos;
+} ArenaMarker;
+
+
+/**
+ * Initialize an arena on a single caller-provided block of memory.
+ * More blocks can be chained with arena_add_block().
+ *
+ * @param memory    Memory to allocate from. It should stay valid as long as
+ *                  the arena is used. A few bytes at the start are used to
+ *                  keep track of the block. May be NULL to start empty.
+ * @param size      Size of the memory in bytes
+ */
+void arena_init(Arena *arena, void *memory, size_t size);
+
+#if ARENA_HAS_MMAP
+/**
+ * Initialize an empty arena that maps memory in chunks when needed.
+ * Caller-provided blocks can still be added with arena_add_block().
+ * Call arena_release() to unmap the chunks.
+ *
+ * @param chunk_size    Size of each mapped chunk in bytes. Allocations that
+ *                      do not fit in a chunk get a larger chunk of their own.
+ */
+void arena_init_mmap(Arena *arena, size_t chunk_size);
+#endif
+
+/**
+ * Chain a caller-provided block of memory to the end of the arena.
+ *
+ * @return  false if the memory is too small to hold a block
+ */
+bool arena_add_block(Arena *arena, void *memory, size_t size);
+
+/**
+ * Release all mapped chunks and forget all caller-provided blocks.
+ * The arena is empty afterwards, but can still map new chunks.
+ */
+void arena_release(Arena *arena);
+
+
+/**
+ * Allocate size bytes, aligned to 'alignment' (a power of 2).
+ * The memory is not initialized.
+ *
+ * @return  pointer to the memory, or NULL if it does not fit
+ */
+void *arena_alloc(Arena *arena, size_t size, size_t alignment);
+
+/**
+ * Same as arena_alloc(), but the memory is zeroed.
+ */
+void *arena_alloc_zero(Arena *arena, size_t size, size_t alignment);
+
+/**
+ * Copy n characters of str (does not have to be null-terminated) into the
+ * arena, and null-terminate the copy.
+ *
+ * @return  the copy, or NULL if it does not fit
+ */
+char *arena_strndup(Arena *arena, const char *str, size_t n);
+
+
+/**
+ * Remember the current position, to free all allocations made after it at
+ * once with arena_restore().
+ */
+ArenaMarker arena_save(const Arena *arena);
+
+/**
+ * Free all allocations made after 'marker' was saved.
+ * Markers saved after 'marker' become invalid.
+ */
+void arena_restore(Arena *arena, ArenaMarker marker);
+
+/**
+ * Free all allocations. All blocks are kept for reuse.
+ */
+void arena_reset(Arena *arena);
+
+
+/*
+ * Header at the start of each block.
+ */
+struct arena_block {
+    ArenaBlock *next;
+    char *end;                          // end of the usable memory
+    size_t map_size;                    // mapped size, 0 if caller-provided
+};
+
+/*
+ * Struct representing an arena 'object'.
+ */
+struct arena {
+    ArenaBlock *first;
+    ArenaBlock *last;
+    ArenaBlock *current;                // block allocations come from
+    char *pos;                          // next free byte in current block
+    char *end;                          // end of current block
+    size_t chunk_size;                  // mmap chunk size, 0: no mapping
+};
+
+#endif
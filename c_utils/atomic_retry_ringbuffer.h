@@ -0,0 +1,159 @@
+#ifndef ATOMIC_RETRY_RINGBUFFER_H
+#define ATOMIC_RETRY_RINGBUFFER_H
+
+#include "ringbuffer.h"
+
+/** atomic_retry_ringbuffer: RetryRingbuffer for concurrent producer/consumer.
+ *
+ * Same claim/cancel/complete model as retry_ringbuffer (@see
+ * retry_ringbuffer.h), but the producer side (write functions) and the
+ * consumer side (read functions) may run concurrently, for example one in
+ * an interrupt handler and the other in a thread, or on different cores.
+ * Shared indices are updated with atomic operations, no locking is needed.
+ *
+ * Rules:
+ * - Only one context may call the write functions (the producer),
+ *   and only one context may call the read functions (the consumer).
+ * - Writes and reads must be completed and canceled in order.
+ * - Overwriting the oldest element (wrapping_write_ptr) never touches an
+ *   element that is claimed by the consumer: claimed data stays intact
+ *   untill the read is completed or canceled.
+ *
+ * NOTE: this relies on the __atomic builtins for size_t. On targets without
+ * native compare-and-swap (e.g. Cortex-M0) these are implemented by libatomic.
+ */
+
+
+typedef struct atomic_retry_ringbuffer AtomicRetryRingbuffer;
+
+
+/**
+ * Initialize an AtomicRetryRingbuffer object.
+ *
+ * Do this before the producer or consumer context starts using it.
+ *
+ * @param ctx           AtomicRetryRingbuffer object to initialize.
+ *
+ * @param ringbuffer    Normal ringbuffer, @see c_utils/ringbuffer.h.
+ *                      NOTE: this ringbuffer should have been initialized
+ *                      with ringbuffer_init()!
+ */
+void atomic_retry_ringbuffer_init(AtomicRetryRingbuffer *ctx,
+        Ringbuffer *ringbuffer);
+
+
+/**
+ * Producer: claim the first available write pointer
+ *
+ * @return              Pointer to the next writeable element
+ *                      if available, NULL if the ringbuffer is full.
+ */
+void *atomic_retry_ringbuffer_claim_write_ptr(AtomicRetryRingbuffer *ctx);
+
+
+/**
+ * Producer: claim the first available write pointer, or replace the oldest
+ * element
+ *
+ * If the ringbuffer is full, the oldest element is discarded to make room.
+ * This is only done if the consumer has not claimed it: a claimed element
+ * is never overwritten while it may be read.
+ *
+ * @return              Pointer to the next writeable element, NULL if
+ *                      the oldest element is claimed by the consumer (or
+ *                      all elements are claimed for writing).
+ */
+void *atomic_retry_ringbuffer_wrapping_write_ptr(AtomicRetryRingbuffer *ctx);
+
+
+/**
+ * Producer: cancel the latest write
+ *
+ * @param write_ptr     Write pointer as returned from claim_write_ptr(),
+ *                      or NULL to skip the sanity check.
+ */
+void atomic_retry_ringbuffer_cancel_write(AtomicRetryRingbuffer *ctx,
+        void *write_ptr);
+
+
+/**
+ * Producer: complete the oldest write
+ *
+ * The element becomes visible to the consumer. The data written to it is
+ * published before the element itself.
+ *
+ * @param write_ptr     Write pointer as returned from claim_write_ptr(),
+ *                      or NULL to skip the sanity check.
+ */
+void atomic_retry_ringbuffer_complete_write(AtomicRetryRingbuffer *ctx,
+        void *write_ptr);
+
+
+/**
+ * Consumer: claim the first available read pointer
+ *
+ * @return              Pointer to the next readable element if available,
+ *                      NULL if no more elements are available.
+ */
+void *atomic_retry_ringbuffer_claim_read_ptr(AtomicRetryRingbuffer *ctx);
+
+
+/**
+ * Consumer: cancel the latest read
+ *
+ * The element becomes available again for claiming (or for being replaced
+ * by the producer if the ringbuffer is full).
+ *
+ * @param read_ptr      Read pointer as returned from claim_read_ptr(),
+ *                      or NULL to skip the sanity check.
+ */
+void atomic_retry_ringbuffer_cancel_read(AtomicRetryRingbuffer *ctx,
+        const void *read_ptr);
+
+
+/**
+ * Consumer: complete the oldest read
+ *
+ * The slot becomes writeable for the producer.
+ *
+ * @param read_ptr      Read pointer as returned from claim_read_ptr(),
+ *                      or NULL to skip the sanity check.
+ */
+void atomic_retry_ringbuffer_complete_read(AtomicRetryRingbuffer *ctx,
+        const void *read_ptr);
+
+
+/**
+ * Consumer: mark all outstanding read pointers as completed.
+ */
+void atomic_retry_ringbuffer_complete_all_reads(AtomicRetryRingbuffer *ctx);
+
+
+/**
+ * Consumer: cancel all outstanding read pointers.
+ */
+void atomic_retry_ringbuffer_cancel_all_reads(AtomicRetryRingbuffer *ctx);
+
+
+/**
+ * Consumer: returns true if no more elements are available for claiming
+ */
+bool atomic_retry_ringbuffer_is_empty(AtomicRetryRingbuffer *ctx);
+
+
+/**
+ * Producer: returns true if no more elements are available for claiming
+ */
+bool atomic_retry_ringbuffer_is_full(AtomicRetryRingbuffer *ctx);
+
+
+struct atomic_retry_ringbuffer {
+    Ringbuffer *ring;
+    RingbufferIndex next_write;         // producer only
+    volatile RingbufferIndex next_read; // claimed by consumer or producer
+    RingbufferIndex oldest_read;        // consumer only
+    size_t num_reads;                   // consumer only
+};
+
+
+#endif
@@ -1,9 +1,16 @@
 #ifndef F2STR_H
 #define F2STR_H
 
+#include <stddef.h>
+
 /* Print float to string. Make sure to supply a buffer (str)
  * that is large enough for the result. If the length of the result is
  * equal to n-1, the buffer was too small and digits may have been lost.
+ * Use f2strn_fixed() to get the length without calling strlen().
+ *
+ * The result is exact: digits and rounding (half to even) are the same as
+ * printf("%.<num_dec>f"). Only integer arithmetic is used, and the stack
+ * usage does not depend on n or num_dec (about 100 bytes of scratch).
  *
  * @param str       buffer to store the result. At least 16 bytes,
  *                  or more depending on the float that is parsed.
@@ -19,4 +26,102 @@
  */
 char *f2strn(float a, char *str, size_t n, const int num_dec);
 
+
+/* Print float to string with num_dec decimals, return the length.
+ *
+ * Same result as f2strn(), but returns the length of the result like
+ * snprintf(): if it is n or more, the result was truncated to n-1
+ * characters. The result is always null-terminated (if n > 0).
+ *
+ * Fast path: for num_dec <= 9 and |a| < 2^34 (about 1.7e10), the
+ * conversion uses a single 64-bit integer, without any float math.
+ * Up to 17 decimals and |a| >= 2^-8 also avoid the exact (slower) path.
+ *
+ * @param str       buffer to store the result
+ * @param n         size of the buffer (str)
+ * @param num_dec   how many decimal places should be printed
+ *
+ * @return          length of the full result, excluding the terminator
+ */
+size_t f2strn_fixed(float a, char *str, size_t n, unsigned int num_dec);
+
+
+/** Buffer size that always fits the result of f2strn_shortest() */
+#define F2STRN_SHORTEST_SIZE (24)
+
+/* Print float to string with the least amount of digits needed to read
+ * back the exact same float (e.g. 0.1f prints as "0.1").
+ *
+ * Notation is like JavaScript: positional for 1e-6 <= |a| < 1e21
+ * ("123.45", "0.000012"), else scientific ("1.5e+30", "1e-10").
+ * Infinity and NaN print as "inf", "-inf" and "nan".
+ *
+ * @param str       buffer to store the result,
+ *                  F2STRN_SHORTEST_SIZE bytes is always enough.
+ * @param n         size of the buffer (str)
+ *
+ * @return          length of the full result, excluding the terminator,
+ *                  like snprintf(). If it is n or more, the result was
+ *                  truncated to n-1 characters.
+ */
+size_t f2strn_shortest(float a, char *str, size_t n);
+
+
+/* Print float to string in exponent notation, return the length.
+ *
+ * Same result as printf("%.<precision>e"): one digit before the point,
+ * 'precision' digits after it and an exponent of at least two digits
+ * ("1.50e+02"). The return value is like f2strn_fixed().
+ */
+size_t f2strn_exp(float a, char *str, size_t n, unsigned int precision);
+
+/* Print float to string with 'precision' significant digits, return the
+ * length.
+ *
+ * Same result as printf("%.<precision>g"): fixed notation for exponents
+ * from -4 up to precision-1, else exponent notation. Trailing zeroes
+ * are removed. The return value is like f2strn_fixed().
+ */
+size_t f2strn_general(float a, char *str, size_t n, unsigned int precision);
+
+
+/* Double versions of the functions above. The results are exact as well,
+ * but the exact path needs more stack: about 420 bytes of scratch.
+ * Values in [2^-8, 2^64) with up to 17 decimals take a 64-bit fast path.
+ */
+size_t d2strn(double a, char *str, size_t n, unsigned int num_dec);
+size_t d2strn_exp(double a, char *str, size_t n, unsigned int precision);
+size_t d2strn_general(double a, char *str, size_t n, unsigned int precision);
+
+/** Buffer size that always fits the result of d2strn_shortest() */
+#define D2STRN_SHORTEST_SIZE (32)
+
+/* Shortest round-trip notation like f2strn_shortest(), for doubles.
+ * Note: uses about 10 kB of lookup tables (in flash on most targets).
+ */
+size_t d2strn_shortest(double a, char *str, size_t n);
+
+
+/* Print an array of floats with num_dec decimals, separated by
+ * 'separator' (e.g. "," or "\t", may be NULL), into one buffer.
+ *
+ * Each value is formatted like f2strn_fixed(). Only whole values are
+ * written: the output stops before the first value (and its separator)
+ * that does not fit. The result is always null-terminated (if n > 0).
+ * The setup is shared by all values, and values on the fast path are
+ * written in place.
+ *
+ * @param values    array of count floats
+ * @param str       buffer to store the result
+ * @param n         size of the buffer (str)
+ * @param len       optional (may be NULL): the length of the result,
+ *                  excluding the terminator
+ *
+ * @return          number of values that were written. If it is less
+ *                  than count, call again with values + the result
+ *                  to continue in a new buffer.
+ */
+size_t f2strn_array(const float *values, size_t count, char *str, size_t n,
+        unsigned int num_dec, const char *separator, size_t *len);
+
 #endif
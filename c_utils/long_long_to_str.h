@@ -3,8 +3,85 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
+/* Print a long long as a decimal string.
+ *
+ * Same result as snprintf("%lld"): the return value is the length of the
+ * full result, excluding the terminator. If it is n or more, the result
+ * was truncated to n-1 characters. The result is always null-terminated
+ * (if n > 0). The digits are written two at a time, straight into str.
+ *
+ * @param str       buffer to store the result. 21 bytes always fits.
+ * @param n         size of the buffer (str)
+ *
+ * @return          length of the full result, excluding the terminator
+ */
+size_t long_long_to_strn(char *str, size_t n, long long val);
+
+/* Print a long long as a decimal string, see long_long_to_strn().
+ *
+ * @return          true if the result fits in result_size bytes
+ *                  (including the terminator)
+ */
 bool long_long_to_str(char *result_str, size_t result_size, long long val);
 
-#endif
 
+/* Unsigned versions. The return value and buffer handling are the same as
+ * long_long_to_strn(): the length of the full result is returned, and the
+ * result is truncated to n-1 characters if it does not fit.
+ */
+
+/* Print an unsigned long long as a decimal string, like "%llu".
+ * 21 bytes always fits.
+ */
+size_t ulong_long_to_strn(char *str, size_t n, unsigned long long val);
+
+/* Print an unsigned long long as a decimal string of at least 'width'
+ * digits, padded with leading zeroes. Same as "%0<width>llu".
+ */
+size_t ulong_long_to_strn_padded(char *str, size_t n,
+        unsigned long long val, unsigned int width);
+
+/* Print an unsigned long long as a hexadecimal string of at least 'width'
+ * digits, padded with leading zeroes, without "0x" prefix.
+ * Same as "%0<width>llx", or "%0<width>llX" if uppercase is true.
+ */
+size_t ulong_long_to_hex_strn(char *str, size_t n,
+        unsigned long long val, unsigned int width, bool uppercase);
+
+/* Print an unsigned long long in any base from 2 to 36 (digits 0-9, a-z),
+ * padded with leading zeroes to at least 'width' digits.
+ * Powers of two (e.g. base 2, 8 or 16) use shifts instead of divisions.
+ *
+ * @param base      2 to 36. Other values trigger an assert, the result
+ *                  is an empty string.
+ */
+size_t ulong_long_to_base_strn(char *str, size_t n,
+        unsigned long long val, unsigned int base, unsigned int width);
+
+
+/* Print an array of integers as decimals, separated by 'separator'
+ * (e.g. "," or "\t", may be NULL), into one buffer.
+ *
+ * Each value is formatted like long_long_to_strn(), straight into str.
+ * Only whole values are written: the output stops before the first value
+ * (and its separator) that does not fit. The result is always
+ * null-terminated (if n > 0).
+ *
+ * @param values    array of count integers
+ * @param str       buffer to store the result
+ * @param n         size of the buffer (str)
+ * @param len       optional (may be NULL): the length of the result,
+ *                  excluding the terminator
+ *
+ * @return          number of values that were written. If it is less
+ *                  than count, call again with values + the result
+ *                  to continue in a new buffer.
+ */
+size_t int32_array_to_strn(const int32_t *values, size_t count,
+        char *str, size_t n, const char *separator, size_t *len);
+size_t int64_array_to_strn(const int64_t *values, size_t count,
+        char *str, size_t n, const char *separator, size_t *len);
+
+#endif
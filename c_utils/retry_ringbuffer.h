@@ -17,6 +17,42 @@
 
 
 typedef struct retry_ringbuffer RetryRingbuffer;
+typedef struct retry_ringbuffer_claimer RetryRingbufferClaimer;
+
+
+/**
+ * A batch of claimed elements, @see retry_ringbuffer_claim_reads().
+ *
+ * Because the ringbuffer wraps around, a batch consists of up to two
+ * contiguous regions. The second region (if any) starts at the beginning
+ * of the ringbuffer data. Unused regions have count 0 and ptr NULL.
+ */
+typedef struct {
+    void *ptr[2];       // first element of each region
+    uint32_t count[2];  // amount of elements in each region
+    uint64_t seq;       // sequence number of the first element
+} RetryRingbufferSpans;
+
+
+/**
+ * What retry_ringbuffer_wrapping_write_ptr() does when the ringbuffer is full
+ */
+typedef enum {
+    RETRY_RINGBUFFER_DROP_OLDEST = 0,   // default: discard the oldest element
+    RETRY_RINGBUFFER_DROP_NEWEST,       // discard the new element (NULL)
+    RETRY_RINGBUFFER_BLOCK,             // nothing is discarded (NULL), retry
+} RetryRingbufferDropPolicy;
+
+
+/**
+ * Drop counters, @see retry_ringbuffer_get_stats().
+ * The counters wrap around on overflow.
+ */
+typedef struct {
+    uint32_t dropped;           // elements discarded (oldest or newest)
+    uint32_t dropped_in_flight; // of which: claimed reads force-completed
+    uint32_t blocked;           // full events with RETRY_RINGBUFFER_BLOCK
+} RetryRingbufferStats;
 
 
 /**
@@ -33,6 +69,42 @@ typedef struct retry_ringbuffer RetryRingbuffer;
 void retry_ringbuffer_init(RetryRingbuffer *ctx, Ringbuffer *ringbuffer);
 
 
+/**
+ * Clock used for read leases, @see retry_ringbuffer_enable_lease().
+ * Returns the current time in arbitrary ticks. Wrapping around is allowed.
+ */
+typedef uint32_t (*RetryRingbufferClock)(void);
+
+
+/**
+ * Amount of uint32_t words required for a completion bitmap,
+ * @see retry_ringbuffer_init_unordered()
+ */
+#define RETRY_RINGBUFFER_BITMAP_WORDS(element_count) \
+    (((element_count) + 31) / 32)
+
+/**
+ * Initialize a RetryRingbuffer object that allows out-of-order completes.
+ *
+ * Same as retry_ringbuffer_init(), but completion is tracked per element.
+ * Claimed elements may be completed in any order: the underlying ringbuffer
+ * only moves past the longest completed prefix, so the other side still
+ * sees the data in FIFO order.
+ *
+ * @param write_done    Bitmap of RETRY_RINGBUFFER_BITMAP_WORDS(element_count)
+ *                      words, used to track completed writes.
+ *                      NULL: writes must be completed in order.
+ *
+ * @param read_done     Bitmap of RETRY_RINGBUFFER_BITMAP_WORDS(element_count)
+ *                      words, used to track completed reads.
+ *                      NULL: reads must be completed in order.
+ *
+ * NOTE: the bitmaps should stay valid for as long as ctx is used.
+ */
+void retry_ringbuffer_init_unordered(RetryRingbuffer *ctx,
+        Ringbuffer *ringbuffer, uint32_t *write_done, uint32_t *read_done);
+
+
 /**
  * Cancel the latest write
  *
@@ -62,12 +134,16 @@ void retry_ringbuffer_cancel_write(RetryRingbuffer *ctx, void *write_ptr);
  * write (that is not yet canceled or completed) can be completed.
  * If you want to complete multiple writes: first complete the oldest write,
  * then the one after it, etc.
+ * If ctx was initialized with a write_done bitmap
+ * (@see retry_ringbuffer_init_unordered), any claimed write can be completed.
+ * The data becomes readable as soon as all older writes are completed too.
  *
  * @param write_ptr     Write pointer as returned from claim_write_ptr().
  *                      This is used to perform a sanity check: completes
  *                      should be done in the right order.
  *                      NULL may be passed in case you don't have access to
- *                      the write_ptr. In this case the check is skipped.
+ *                      the write_ptr. In this case the oldest write is
+ *                      completed.
  */
 void retry_ringbuffer_complete_write(RetryRingbuffer *ctx, void *write_ptr);
 
@@ -85,6 +161,96 @@ void retry_ringbuffer_complete_write(RetryRingbuffer *ctx, void *write_ptr);
 void *retry_ringbuffer_claim_read_ptr(RetryRingbuffer *ctx);
 
 
+/**
+ * Enable leases on claimed reads
+ *
+ * Every claimed read gets a deadline of lease_ticks after the moment it
+ * was claimed. When the oldest outstanding read is not completed before
+ * its deadline, the consumer is assumed to be dead or stalled: all
+ * outstanding reads are canceled and handed out again by the next claim
+ * (reads completed out-of-order in the meantime are not handed out again).
+ * This gives at-least-once delivery: every element is eventually completed.
+ *
+ * Expired leases are checked when claiming a read, or explicitly with
+ * retry_ringbuffer_requeue_expired(). Because reads are claimed in order,
+ * only the oldest outstanding read has to be checked.
+ *
+ * A read that expired is no longer claimed: completing it later has no
+ * effect (it will be delivered again). A consumer that may have been
+ * stalled should compare retry_ringbuffer_lease_epoch() with the value
+ * at the time it claimed its reads, and drop them if it has changed.
+ *
+ * @param deadlines     Array of element_count uint32_t's, used to store the
+ *                      deadline of each claimed read.
+ *                      NOTE: it should stay valid for as long as ctx is used.
+ *
+ * @param lease_ticks   Lease duration, in ticks of the clock
+ *
+ * @param clock         Function returning the current time in ticks
+ */
+void retry_ringbuffer_enable_lease(RetryRingbuffer *ctx, uint32_t *deadlines,
+        uint32_t lease_ticks, RetryRingbufferClock clock);
+
+/**
+ * Cancel all outstanding reads if the oldest one has an expired lease
+ *
+ * Called automatically when claiming reads, see enable_lease().
+ *
+ * @return              Amount of reads that are handed out again
+ */
+size_t retry_ringbuffer_requeue_expired(RetryRingbuffer *ctx);
+
+/**
+ * Get the lease epoch: a counter that increments every time outstanding
+ * reads are canceled because their lease expired.
+ */
+uint32_t retry_ringbuffer_lease_epoch(const RetryRingbuffer *ctx);
+
+
+/**
+ * Cancel the latest read
+ *
+ * Cancel reading from the pointer previously claimed with claim_read_ptr().
+ * The element becomes available again for claiming.
+ *
+ * NOTE: cancels should be done in order: only the latest
+ * read (that is not yet canceled or completed) can be canceled.
+ * If you want to cancel multiple reads: first cancel the last read,
+ * then the one before it, etc.
+ *
+ * @param read_ptr      read pointer as returned from claim_read_ptr().
+ *                      This is used to perform a sanity check: cancels should
+ *                      be done in the right order.
+ *                      NULL may be passed in case you don't have access to
+ *                      the read_ptr. In this case the check is skipped.
+ */
+void retry_ringbuffer_cancel_read(RetryRingbuffer *ctx, const void *read_ptr);
+
+
+/**
+ * Complete a read
+ *
+ * Complete reading from the read pointer previously claimed with
+ * claim_read_ptr().
+ *
+ * NOTE: completes should be done in order: only the first
+ * read (that is not yet canceled or completed) can be completed.
+ * If you want to complete multiple reads: first complete the oldest read,
+ * then the one after it, etc.
+ * If ctx was initialized with a read_done bitmap
+ * (@see retry_ringbuffer_init_unordered), any claimed read can be completed.
+ * The slot becomes writable as soon as all older reads are completed too.
+ *
+ * @param read_ptr      read pointer as returned from claim_read_ptr().
+ *                      This is used to perform a sanity check: completes
+ *                      should be done in the right order.
+ *                      NULL may be passed in case you don't have access to
+ *                      the read_ptr. In this case the oldest read is
+ *                      completed.
+ */
+void retry_ringbuffer_complete_read(RetryRingbuffer *ctx, const void *read_ptr);
+
+
 /**
  * Claim the first available write pointer, or replace oldest element
  *
@@ -98,6 +264,197 @@ void *retry_ringbuffer_claim_read_ptr(RetryRingbuffer *ctx);
  */
 void* retry_ringbuffer_wrapping_write_ptr(RetryRingbuffer *ctx);
 
+/**
+ * Set the drop policy of wrapping_write_ptr()
+ *
+ * RETRY_RINGBUFFER_DROP_OLDEST (default): the oldest element is discarded
+ * to make room. If it is claimed for reading, that read is force-completed.
+ * RETRY_RINGBUFFER_DROP_NEWEST: wrapping_write_ptr() returns NULL, the new
+ * element is counted as dropped.
+ * RETRY_RINGBUFFER_BLOCK: wrapping_write_ptr() returns NULL, the caller
+ * should keep the element and try again later. Nothing is dropped.
+ */
+void retry_ringbuffer_set_drop_policy(RetryRingbuffer *ctx,
+        RetryRingbufferDropPolicy policy);
+
+/**
+ * Get the drop counters
+ *
+ * @param stats         Output: copy of the counters since init or the last
+ *                      reset_stats()
+ */
+void retry_ringbuffer_get_stats(const RetryRingbuffer *ctx,
+        RetryRingbufferStats *stats);
+
+/**
+ * Reset all drop counters to zero
+ */
+void retry_ringbuffer_reset_stats(RetryRingbuffer *ctx);
+
+/**
+ * Claim up to max read pointers at once
+ *
+ * Equivalent to calling claim_read_ptr() up to max times, but all elements
+ * are returned in one go as (up to) two contiguous regions.
+ * If ctx allows out-of-order completes, the batch ends before the first
+ * element that was already completed.
+ *
+ * @param max           Maximum amount of elements to claim
+ *
+ * @param spans         Output: regions of claimed elements
+ *
+ * @return              Amount of elements claimed, may be zero.
+ */
+uint32_t retry_ringbuffer_claim_reads(RetryRingbuffer *ctx, uint32_t max,
+        RetryRingbufferSpans *spans);
+
+/**
+ * Complete the oldest count outstanding reads
+ *
+ * Equivalent to calling complete_read(ctx, NULL) count times.
+ * This takes constant time unless reads were completed out-of-order.
+ */
+void retry_ringbuffer_complete_reads(RetryRingbuffer *ctx, uint32_t count);
+
+/**
+ * Cancel the latest count outstanding reads
+ *
+ * Equivalent to calling cancel_read(ctx, NULL) count times.
+ * This takes constant time unless reads were completed out-of-order.
+ */
+void retry_ringbuffer_cancel_reads(RetryRingbuffer *ctx, uint32_t count);
+
+/**
+ * Claim up to max write pointers at once
+ *
+ * Claims as many writeable elements as available (up to max), returned as
+ * (up to) two contiguous regions. Unlike wrapping_write_ptr(), this never
+ * overwrites old elements.
+ *
+ * @param max           Maximum amount of elements to claim
+ *
+ * @param spans         Output: regions of claimed elements
+ *
+ * @return              Amount of elements claimed, may be zero.
+ */
+uint32_t retry_ringbuffer_claim_writes(RetryRingbuffer *ctx, uint32_t max,
+        RetryRingbufferSpans *spans);
+
+/**
+ * Complete the oldest count outstanding writes
+ *
+ * Equivalent to calling complete_write(ctx, NULL) count times.
+ * This takes constant time unless ctx allows out-of-order write completes.
+ */
+void retry_ringbuffer_complete_writes(RetryRingbuffer *ctx, uint32_t count);
+
+/**
+ * Cancel the latest count outstanding writes
+ *
+ * Equivalent to calling cancel_write(ctx, NULL) count times.
+ * This takes constant time unless ctx allows out-of-order write completes.
+ */
+void retry_ringbuffer_cancel_writes(RetryRingbuffer *ctx, uint32_t count);
+
+/**
+ * Get the sequence number of an element
+ *
+ * Every element written to the ringbuffer gets a sequence number, counting
+ * up from 0 (since init) in FIFO order. This allows acknowledging ranges of
+ * reads in one step, @see retry_ringbuffer_ack_up_to().
+ * The sequence number of the first element of a batch is also available
+ * in RetryRingbufferSpans.seq.
+ *
+ * @param ptr           Pointer to a claimed (read or write) element,
+ *                      or to a readable element.
+ */
+uint64_t retry_ringbuffer_seq(const RetryRingbuffer *ctx, const void *ptr);
+
+/**
+ * Cumulative ack: complete all reads up to and including seq
+ *
+ * All elements up to and including seq are released at once (the slots
+ * become writable), whether they are claimed, completed or requeued by
+ * retry_ringbuffer_nack(). Sequence numbers that are already released are
+ * ignored (duplicate or stale acks).
+ * This takes constant time unless reads were completed out-of-order.
+ *
+ * @param seq           Sequence number of a readable element
+ */
+void retry_ringbuffer_ack_up_to(RetryRingbuffer *ctx, uint64_t seq);
+
+/**
+ * Selective ack: complete the single read with sequence number seq
+ *
+ * If the element is not claimed (any more), it is skipped when claiming.
+ * Acks of released or already completed elements are ignored.
+ * NOTE: only the oldest element can be acked, unless ctx was initialized
+ * with a read_done bitmap (@see retry_ringbuffer_init_unordered).
+ *
+ * @param seq           Sequence number of a readable element
+ */
+void retry_ringbuffer_ack(RetryRingbuffer *ctx, uint64_t seq);
+
+/**
+ * Go-back-N: cancel the read with sequence number seq and all later reads
+ *
+ * The element and all reads claimed after it become available again for
+ * claiming. Reads that were completed out-of-order are not handed out again.
+ * Sequence numbers that are not claimed (e.g. already released or requeued)
+ * are ignored.
+ *
+ * @param seq           Sequence number of a readable element
+ */
+void retry_ringbuffer_nack(RetryRingbuffer *ctx, uint64_t seq);
+
+/**
+ * Register a claimer: one of multiple consumers of a shared RetryRingbuffer
+ *
+ * Every claimer holds (at most) one window of claimed reads. Windows of
+ * different claimers are disjoint, and can be completed in any order:
+ * slots are released up to the oldest incomplete read of all claimers.
+ * This requires a read_done bitmap, @see retry_ringbuffer_init_unordered().
+ *
+ * A canceled window is handed out again: directly if no newer reads are
+ * claimed, else it is parked and picked up by the next claim (of any
+ * claimer) that fits it. Parked reads still count as claimed.
+ * cancel_all_reads(), nack() and expired leases requeue all windows:
+ * completing or canceling a requeued window has no effect.
+ *
+ * NOTE: do not mix claimers with the other claim/cancel functions on ctx.
+ * Completing via ack_up_to() or complete_all_reads() is allowed.
+ *
+ * @param claimer       Claimer object to initialize, should stay valid for
+ *                      as long as ctx is used.
+ */
+void retry_ringbuffer_claimer_init(RetryRingbufferClaimer *claimer,
+        RetryRingbuffer *ctx);
+
+/**
+ * Claim a window of up to max reads
+ *
+ * A parked window is taken first, if it has at most max reads.
+ * NOTE: the claimer should not hold a window, except for a parked window
+ * of its own (of at most max reads): that window is taken back.
+ *
+ * @param spans         Output: regions of claimed elements
+ *
+ * @return              Amount of elements claimed, may be zero.
+ */
+uint32_t retry_ringbuffer_claimer_claim(RetryRingbufferClaimer *claimer,
+        uint32_t max, RetryRingbufferSpans *spans);
+
+/**
+ * Complete the oldest count reads of the claimer window
+ */
+void retry_ringbuffer_claimer_complete(RetryRingbufferClaimer *claimer,
+        uint32_t count);
+
+/**
+ * Cancel the remaining reads of the claimer window
+ */
+void retry_ringbuffer_claimer_cancel(RetryRingbufferClaimer *claimer);
+
 /**
  * Mark all outstanding read pointers as completed.
  * This means the slots will be writable again without discarding elements.
@@ -126,6 +483,26 @@ struct retry_ringbuffer {
     volatile RingbufferIndex next_write;
     volatile RingbufferIndex next_read;
     volatile size_t num_reads;
+    uint64_t read_seq;                  // sequence number of ring->read
+    uint32_t *write_done;               // optional: completed writes bitmap
+    uint32_t *read_done;                // optional: completed reads bitmap
+    uint32_t *lease_deadlines;          // optional: deadline per claimed read
+    RetryRingbufferClock lease_clock;
+    uint32_t lease_ticks;
+    volatile uint32_t lease_epoch;      // increments on every lease expiry
+    RetryRingbufferDropPolicy drop_policy;
+    RetryRingbufferStats stats;
+    RetryRingbufferClaimer *claimers;   // list of registered claimers
+    uint32_t claim_epoch;               // increments when reads are requeued
+};
+
+struct retry_ringbuffer_claimer {
+    RetryRingbuffer *ctx;
+    RetryRingbufferClaimer *next;
+    uint64_t seq;                       // first outstanding read of window
+    uint32_t count;                     // outstanding reads in window
+    uint32_t epoch;                     // claim_epoch of the window
+    bool parked;                        // canceled, waiting to be claimed
 };
 
 
@@ -0,0 +1,215 @@
+#include "arena.h"
+#include "align.h"
+#include "assert.h"
+#include <stdint.h>
+#include <string.h>
+
+#if ARENA_HAS_MMAP
+#include <sys/mman.h>
+#endif
+
+static char *block_data(ArenaBlock *block)
+{
+    return (char *)(block + 1);
+}
+
+static void enter_block(Arena *arena, ArenaBlock *block)
+{
+    arena->current = block;
+    arena->pos = block ? block_data(block) : NULL;
+    arena->end = block ? block->end : NULL;
+}
+
+static void append_block(Arena *arena, ArenaBlock *block)
+{
+    block->next = NULL;
+    if(arena->last) {
+        arena->last->next = block;
+    } else {
+        arena->first = block;
+    }
+    arena->last = block;
+}
+
+static void init_empty(Arena *arena, size_t chunk_size)
+{
+    arena->first = NULL;
+    arena->last = NULL;
+    arena->chunk_size = chunk_size;
+    enter_block(arena, NULL);
+}
+
+void arena_init(Arena *arena, void *memory, size_t size)
+{
+    init_empty(arena, 0);
+    if(memory) {
+        const bool added = arena_add_block(arena, memory, size);
+        assert(added);
+    }
+}
+
+#if ARENA_HAS_MMAP
+void arena_init_mmap(Arena *arena, size_t chunk_size)
+{
+    assert(chunk_size);
+    init_empty(arena, chunk_size);
+}
+#endif
+
+bool arena_add_block(Arena *arena, void *memory, size_t size)
+{
+    ArenaBlock *block = align(memory, __alignof__(ArenaBlock));
+    const size_t skip = (size_t)((char *)block - (char *)memory);
+    if(size < (skip + sizeof(ArenaBlock))) {
+        return false;
+    }
+    block->end = (char *)memory + size;
+    block->map_size = 0;
+    append_block(arena, block);
+
+    // an empty arena allocates from the new block right away
+    if(!arena->current) {
+        enter_block(arena, block);
+    }
+    return true;
+}
+
+// Map a new chunk that fits at least 'size' bytes at 'alignment'
+static ArenaBlock *map_block(Arena *arena, size_t size, size_t alignment)
+{
+#if ARENA_HAS_MMAP
+    if(!arena->chunk_size) {
+        return NULL;
+    }
+    const size_t overhead = sizeof(ArenaBlock) + alignment - 1;
+    if(size > (SIZE_MAX - overhead)) {
+        return NULL;
+    }
+    size_t map_size = size + overhead;
+    if(map_size < arena->chunk_size) {
+        map_size = arena->chunk_size;
+    }
+    void *memory = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED) {
+        return NULL;
+    }
+    // mmap returns page aligned memory: the header is aligned already
+    ArenaBlock *block = memory;
+    block->end = (char *)memory + map_size;
+    block->map_size = map_size;
+    append_block(arena, block);
+    return block;
+#else
+    return NULL;
+#endif
+}
+
+void arena_release(Arena *arena)
+{
+#if ARENA_HAS_MMAP
+    ArenaBlock *block = arena->first;
+    while(block) {
+        ArenaBlock *next = block->next;
+        if(block->map_size) {
+            munmap(block, block->map_size);
+        }
+        block = next;
+    }
+#endif
+    init_empty(arena, arena->chunk_size);
+}
+
+// Allocate from the current block only
+static void *try_alloc(Arena *arena, size_t size, size_t alignment)
+{
+    if(!arena->pos) {
+        return NULL;
+    }
+    char *result = align(arena->pos, alignment);
+    if((result > arena->end) || (size > (size_t)(arena->end - result))) {
+        return NULL;
+    }
+    arena->pos = result + size;
+    return result;
+}
+
+// The current block is full: continue in the next block that fits,
+// mapping a new one at the end of the chain if needed.
+static void *alloc_next_block(Arena *arena, size_t size, size_t alignment)
+{
+    for(;;) {
+        ArenaBlock *next = arena->current ? arena->current->next
+            : arena->first;
+        if(!next) {
+            next = map_block(arena, size, alignment);
+            if(!next) {
+                return NULL;
+            }
+        }
+        enter_block(arena, next);
+
+        void *result = try_alloc(arena, size, alignment);
+        if(result) {
+            return result;
+        }
+    }
+}
+
+void *arena_alloc(Arena *arena, size_t size, size_t alignment)
+{
+    assert(alignment && !(alignment & (alignment - 1)));
+
+    void *result = try_alloc(arena, size, alignment);
+    if(result) {
+        return result;
+    }
+    return alloc_next_block(arena, size, alignment);
+}
+
+void *arena_alloc_zero(Arena *arena, size_t size, size_t alignment)
+{
+    void *result = arena_alloc(arena, size, alignment);
+    if(result) {
+        memset(result, 0, size);
+    }
+    return result;
+}
+
+char *arena_strndup(Arena *arena, const char *str, size_t n)
+{
+    if(n == SIZE_MAX) {
+        return NULL;
+    }
+    char *result = arena_alloc(arena, n + 1, 1);
+    if(result) {
+        memcpy(result, str, n);
+        result[n] = '\0';
+    }
+    return result;
+}
+
+ArenaMarker arena_save(const Arena *arena)
+{
+    const ArenaMarker marker = {
+        .block = arena->current,
+        .pos = arena->pos,
+    };
+    return marker;
+}
+
+void arena_restore(Arena *arena, ArenaMarker marker)
+{
+    if(!marker.block) {
+        arena_reset(arena);
+        return;
+    }
+    arena->current = marker.block;
+    arena->pos = marker.pos;
+    arena->end = marker.block->end;
+}
+
+void arena_reset(Arena *arena)
+{
+    enter_block(arena, arena->first);
+}
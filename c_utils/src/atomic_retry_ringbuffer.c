@@ -0,0 +1,268 @@
+#include "atomic_retry_ringbuffer.h"
+#include <assert.h>
+
+/*
+ * Ownership of the indices:
+ *
+ * - ring->write, ctx->next_write: producer only.
+ * - ctx->oldest_read, ctx->num_reads: consumer only.
+ * - ctx->next_read: moved forward by the consumer when claiming, or by the
+ *   producer when it discards the (unclaimed) oldest element. Both use
+ *   compare-and-swap, so exactly one of them gets the element.
+ * - ring->read: moved forward by the consumer when completing, or by the
+ *   producer after it discarded the oldest element.
+ *   The producer only does so via compare-and-swap from an element it owns,
+ *   so it can never move ring->read backwards.
+ */
+
+static RingbufferIndex load_index(const volatile RingbufferIndex *index)
+{
+    RingbufferIndex result;
+    result.raw = __atomic_load_n(&index->raw, __ATOMIC_ACQUIRE);
+    return result;
+}
+
+static void store_index(volatile RingbufferIndex *index,
+        RingbufferIndex value)
+{
+    __atomic_store_n(&index->raw, value.raw, __ATOMIC_RELEASE);
+}
+
+static bool cas_index(volatile RingbufferIndex *index,
+        RingbufferIndex expected, RingbufferIndex desired)
+{
+    return __atomic_compare_exchange_n(&index->raw, &expected.raw,
+            desired.raw, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// return the next index relative to the supplied one
+static RingbufferIndex next_index(const Ringbuffer *ringbuffer,
+        RingbufferIndex index)
+{
+    index.offset+= ringbuffer->elem_sz;
+
+    // index past end, wrap: move to first item, toggle wrap bit
+    if(index.offset >= ringbuffer->num_bytes) {
+        index.offset = 0;
+        index.wrap^=1;
+    }
+    return index;
+}
+
+// return the previous index relative to the supplied one
+static RingbufferIndex prev_index(const Ringbuffer *ringbuffer,
+        RingbufferIndex index)
+{
+    index.offset-= ringbuffer->elem_sz;
+
+    // index underflow, undo wrap: move to last item, toggle wrap bit
+    if(index.offset >= ringbuffer->num_bytes) {
+        index.offset = ringbuffer->num_bytes - ringbuffer->elem_sz;
+        index.wrap^=1;
+    }
+    return index;
+}
+
+void atomic_retry_ringbuffer_init(AtomicRetryRingbuffer *ctx,
+        Ringbuffer *ringbuffer)
+{
+    assert(ringbuffer_is_initialized(ringbuffer));
+    ctx->ring = ringbuffer;
+
+    ctx->next_write = ringbuffer->write;
+    ctx->next_read = ringbuffer->read;
+    ctx->oldest_read = ringbuffer->read;
+    ctx->num_reads = 0;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+bool atomic_retry_ringbuffer_is_full(AtomicRetryRingbuffer *ctx)
+{
+    const RingbufferIndex read = load_index(&ctx->ring->read);
+    const RingbufferIndex write = ctx->next_write;
+
+    return ((read.offset == write.offset)
+            && (read.wrap != write.wrap));
+}
+
+bool atomic_retry_ringbuffer_is_empty(AtomicRetryRingbuffer *ctx)
+{
+    const RingbufferIndex read = load_index(&ctx->next_read);
+    const RingbufferIndex write = load_index(&ctx->ring->write);
+
+    return (read.raw == write.raw);
+}
+
+void *atomic_retry_ringbuffer_claim_write_ptr(AtomicRetryRingbuffer *ctx)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    const bool full = atomic_retry_ringbuffer_is_full(ctx);
+    ring->overflow = full;
+
+    if(full) {
+        return NULL;
+    }
+
+    const RingbufferIndex next_w = ctx->next_write;
+    ctx->next_write = next_index(ring, next_w);
+
+    return ring->first_elem + next_w.offset;
+}
+
+void *atomic_retry_ringbuffer_wrapping_write_ptr(AtomicRetryRingbuffer *ctx)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    void *dst = atomic_retry_ringbuffer_claim_write_ptr(ctx);
+    if(dst) {
+        return dst;
+    }
+
+    // Full: discard the oldest element. All slots may be claimed for
+    // writing, in which case there is no element to discard.
+    const RingbufferIndex read = load_index(&ring->read);
+    if(read.raw == ring->write.raw) {
+        return NULL;
+    }
+
+    // Take the oldest element away from the consumer. This fails if the
+    // consumer claimed it (or completed it) in the meantime.
+    const RingbufferIndex next = next_index(ring, read);
+    if(cas_index(&ctx->next_read, read, next)) {
+
+        // The consumer may already have moved ring->read past this element
+        // by completing a newer read: no need to retry on failure.
+        cas_index(&ring->read, read, next);
+    }
+
+    // succeeds if the element was discarded or completed by the consumer
+    return atomic_retry_ringbuffer_claim_write_ptr(ctx);
+}
+
+void atomic_retry_ringbuffer_cancel_write(AtomicRetryRingbuffer *ctx,
+        void *write_ptr)
+{
+    const Ringbuffer *ring = ctx->ring;
+    const RingbufferIndex prev = prev_index(ring, ctx->next_write);
+
+    // assertion: cannot cancel more writes than claimed
+    assert(ctx->next_write.raw != ring->write.raw);
+
+    if(write_ptr) {
+        // assertion: canceled write should be the last claimed write
+        assert(write_ptr == (ring->first_elem + prev.offset));
+    }
+
+    ctx->next_write = prev;
+}
+
+void atomic_retry_ringbuffer_complete_write(AtomicRetryRingbuffer *ctx,
+        void *write_ptr)
+{
+    Ringbuffer *ring = ctx->ring;
+    const RingbufferIndex write = ring->write;
+
+    // assertion: cannot complete more writes than claimed
+    assert(ctx->next_write.raw != write.raw);
+
+    if(write_ptr) {
+        // assertion: completed write should be the first non-completed write
+        assert(write_ptr == (ring->first_elem + write.offset));
+    }
+
+    // release: the element data is visible before the element itself
+    store_index(&ring->write, next_index(ring, write));
+}
+
+void *atomic_retry_ringbuffer_claim_read_ptr(AtomicRetryRingbuffer *ctx)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    for(;;) {
+        const RingbufferIndex next_r = load_index(&ctx->next_read);
+        const RingbufferIndex write = load_index(&ring->write);
+
+        if(next_r.raw == write.raw) {
+            return NULL;
+        }
+
+        if(cas_index(&ctx->next_read, next_r, next_index(ring, next_r))) {
+            if(!ctx->num_reads) {
+                ctx->oldest_read = next_r;
+            }
+            ctx->num_reads+= 1;
+
+            return ring->first_elem + next_r.offset;
+        }
+
+        // the producer discarded this element in the meantime: try again
+    }
+}
+
+void atomic_retry_ringbuffer_cancel_read(AtomicRetryRingbuffer *ctx,
+        const void *read_ptr)
+{
+    const Ringbuffer *ring = ctx->ring;
+
+    // assertion: cannot cancel more reads than claimed
+    assert(ctx->num_reads);
+
+    // the producer never moves next_read while reads are claimed
+    const RingbufferIndex next_r = load_index(&ctx->next_read);
+    const RingbufferIndex prev = prev_index(ring, next_r);
+
+    if(read_ptr) {
+        // assertion: canceled read should be the last claimed read
+        assert(read_ptr == (ring->first_elem + prev.offset));
+    }
+
+    store_index(&ctx->next_read, prev);
+    ctx->num_reads-= 1;
+}
+
+void atomic_retry_ringbuffer_complete_read(AtomicRetryRingbuffer *ctx,
+        const void *read_ptr)
+{
+    Ringbuffer *ring = ctx->ring;
+    const RingbufferIndex oldest = ctx->oldest_read;
+
+    // assertion: cannot complete more reads than claimed
+    assert(ctx->num_reads);
+
+    if(read_ptr) {
+        // assertion: completed read should be the first non-completed read
+        assert(read_ptr == (ring->first_elem + oldest.offset));
+    }
+
+    // release: done reading the element before the slot is handed over
+    const RingbufferIndex next = next_index(ring, oldest);
+    store_index(&ring->read, next);
+
+    ctx->oldest_read = next;
+    ctx->num_reads-= 1;
+}
+
+void atomic_retry_ringbuffer_complete_all_reads(AtomicRetryRingbuffer *ctx)
+{
+    if(!ctx->num_reads) {
+        return;
+    }
+
+    const RingbufferIndex next_r = load_index(&ctx->next_read);
+    store_index(&ctx->ring->read, next_r);
+
+    ctx->oldest_read = next_r;
+    ctx->num_reads = 0;
+}
+
+void atomic_retry_ringbuffer_cancel_all_reads(AtomicRetryRingbuffer *ctx)
+{
+    if(!ctx->num_reads) {
+        return;
+    }
+
+    store_index(&ctx->next_read, ctx->oldest_read);
+    ctx->num_reads = 0;
+}
@@ -1,36 +1,302 @@
 #include "long_long_to_str.h"
+#include "assert.h"
 
+#include <stdint.h>
 #include <string.h>
-#if defined(__linux__)
-#include <bsd/string.h>
-#endif
 
-bool long_long_to_str(char *result_str, size_t result_size, long long val)
+// Longest digit string: 2^64-1 in base 2
+#define MAX_DIGITS          (64)
+
+static const char DIGIT_PAIRS[200] =
+    "00010203040506070809" "10111213141516171819"
+    "20212223242526272829" "30313233343536373839"
+    "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879"
+    "80818283848586878889" "90919293949596979899";
+
+static const char DIGITS_LOWER[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+static const char DIGITS_UPPER[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static const unsigned long long POW10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL};
+
+static unsigned int bit_length(unsigned long long v)
+{
+    return 64 - __builtin_clzll(v | 1);
+}
+
+// number of decimal digits of v, at least 1
+static size_t decimal_length(unsigned long long v)
+{
+    v|= 1; // 0 has one digit, like 1
+    // log10(2) ~ 1233 / 4096: the estimate is exact or one too high
+    const unsigned int estimate = (bit_length(v) * 1233) >> 12;
+    return estimate + 1 - (v < POW10[estimate]);
+}
+
+// number of digits of v in a base other than 10, at least 1
+static size_t base_length(unsigned long long v, unsigned int base)
 {
-    // Edge case
-    if(val == 0) {
-        return (strlcpy(result_str, "0", result_size) < result_size);
+    // power of two: a whole number of bits per digit
+    if(!(base & (base - 1))) {
+        const unsigned int shift = bit_length(base - 1);
+        return (bit_length(v) + shift - 1) / shift;
+    }
+    size_t len = 1;
+    while(v >= base) {
+        v/= base;
+        len++;
     }
+    return len;
+}
+
+static void write_pair(char *p, uint32_t pair)
+{
+    memcpy(p, &DIGIT_PAIRS[2 * pair], 2);
+}
 
-    char buff[64];
-    memset(buff, 0, sizeof(buff));
+// write exactly 8 digits of v (< 10^8): the halves are independent
+static void write_8_digits(char *p, uint32_t v)
+{
+    const uint32_t high = v / 10000;
+    const uint32_t low = v % 10000;
+    write_pair(p, high / 100);
+    write_pair(p + 2, high % 100);
+    write_pair(p + 4, low / 100);
+    write_pair(p + 6, low % 100);
+}
 
-    int i = 62;
-    int sign = (val < 0);
-    unsigned long long unsigned_val = val;
-    if(sign) {
-        unsigned_val = -val;
+// write the decimal digits of v two at a time, ending just before 'end'
+static void write_decimal_backwards(unsigned long long v, char *end)
+{
+    char *p = end;
+
+    // split off 8 digits at a time, so the rest is 32-bit math (cheap on MCUs)
+    while(v >= 100000000) {
+        p-= 8;
+        write_8_digits(p, v % 100000000);
+        v/= 100000000;
+    }
+
+    uint32_t v32 = v;
+    while(v32 >= 100) {
+        p-= 2;
+        write_pair(p, v32 % 100);
+        v32/= 100;
     }
+    if(v32 >= 10) {
+        p-= 2;
+        write_pair(p, v32);
+    } else {
+        *(--p) = '0' + v32;
+    }
+}
 
+// write exactly len digits of v in a base other than 10,
+// ending just before 'end'
+static void write_digits_backwards(unsigned long long v, char *end,
+        size_t len, unsigned int base, const char *digits)
+{
+    if(!(base & (base - 1))) {
+        // power of two (e.g. hex): shift and mask, no division
+        const unsigned int shift = bit_length(base - 1);
+        for(size_t i=1; i<=len; i++) {
+            end[-i] = digits[v & (base - 1)];
+            v>>= shift;
+        }
+    } else {
+        for(size_t i=1; i<=len; i++) {
+            end[-i] = digits[v % base];
+            v/= base;
+        }
+    }
+}
 
-    for(; unsigned_val && i ; --i, unsigned_val /= 10) {
-        buff[i] = "0123456789"[unsigned_val % 10];
+// The result did not fit: write as much of ['-'][pad zeroes][digits]
+// as fits in n-1 characters
+static void write_truncated(char *str, size_t n, bool sign, size_t pad,
+        const char *digits, size_t num_digits)
+{
+    size_t i = 0;
+    const size_t max = n - 1;
+    if(sign && (i < max)) {
+        str[i++] = '-';
+    }
+    for(size_t p=0; (p < pad) && (i < max); p++) {
+        str[i++] = '0';
     }
+    for(size_t d=0; (d < num_digits) && (i < max); d++) {
+        str[i++] = digits[d];
+    }
+    str[i] = '\0';
+}
+
+// Write ['-'][zero padding up to width][decimal digits of v], bounded by n.
+// Returns the full length like snprintf().
+static size_t format_decimal(char *str, size_t n, bool sign,
+        unsigned long long v, unsigned int width)
+{
+    const size_t num_digits = decimal_length(v);
+    const size_t pad = (width > num_digits) ? (width - num_digits) : 0;
+    const size_t len = sign + pad + num_digits;
+
+    if(len < n) {
+        // common case: write straight into the result
+        if(sign) {
+            str[0] = '-';
+        }
+        if(pad) {
+            memset(str + sign, '0', pad);
+        }
+        write_decimal_backwards(v, str + len);
+        str[len] = '\0';
+    } else if(n) {
+        char buf[MAX_DIGITS];
+        write_decimal_backwards(v, buf + num_digits);
+        write_truncated(str, n, sign, pad, buf, num_digits);
+    }
+    return len;
+}
+
+// Same as format_decimal() for unsigned values in other bases
+static size_t format_base(char *str, size_t n, unsigned long long v,
+        unsigned int base, const char *digits, unsigned int width)
+{
+    const size_t num_digits = base_length(v, base);
+    const size_t pad = (width > num_digits) ? (width - num_digits) : 0;
+    const size_t len = pad + num_digits;
 
+    if(len < n) {
+        memset(str, '0', pad);
+        write_digits_backwards(v, str + len, num_digits, base, digits);
+        str[len] = '\0';
+    } else if(n) {
+        char buf[MAX_DIGITS];
+        write_digits_backwards(v, buf + num_digits, num_digits, base, digits);
+        write_truncated(str, n, false, pad, buf, num_digits);
+    }
+    return len;
+}
+
+// Append [separator] and the decimal value to str at *total, only if both
+// fit (with the terminator). The digits are written in place.
+static bool append_decimal(char *str, size_t n, size_t *total,
+        const char *separator, size_t separator_len,
+        bool sign, unsigned long long v)
+{
+    const size_t len = separator_len + sign + decimal_length(v);
+    if(*total + len >= n) {
+        return false;
+    }
+    char *p = str + *total;
+    if(separator_len) {
+        memcpy(p, separator, separator_len);
+    }
     if(sign) {
-        buff[i--] = '-';
+        p[separator_len] = '-';
+    }
+    write_decimal_backwards(v, p + len);
+    *total+= len;
+    return true;
+}
+
+static size_t finish_array(char *str, size_t n, size_t total, size_t *len,
+        size_t written)
+{
+    if(n) {
+        str[total] = '\0';
+    }
+    if(len) {
+        *len = total;
+    }
+    return written;
+}
+
+size_t long_long_to_strn(char *str, size_t n, long long val)
+{
+    const bool sign = (val < 0);
+    // negate as unsigned: also correct for LLONG_MIN
+    const unsigned long long magnitude = sign
+        ? (0ULL - (unsigned long long)val) : (unsigned long long)val;
+    return format_decimal(str, n, sign, magnitude, 0);
+}
+
+bool long_long_to_str(char *result_str, size_t result_size, long long val)
+{
+    return (long_long_to_strn(result_str, result_size, val) < result_size);
+}
+
+size_t ulong_long_to_strn(char *str, size_t n, unsigned long long val)
+{
+    return format_decimal(str, n, false, val, 0);
+}
+
+size_t ulong_long_to_strn_padded(char *str, size_t n,
+        unsigned long long val, unsigned int width)
+{
+    return format_decimal(str, n, false, val, width);
+}
+
+size_t ulong_long_to_hex_strn(char *str, size_t n,
+        unsigned long long val, unsigned int width, bool uppercase)
+{
+    return format_base(str, n, val, 16,
+            uppercase ? DIGITS_UPPER : DIGITS_LOWER, width);
+}
+
+size_t ulong_long_to_base_strn(char *str, size_t n,
+        unsigned long long val, unsigned int base, unsigned int width)
+{
+    assert((base >= 2) && (base <= 36));
+    if((base < 2) || (base > 36)) {
+        if(n) {
+            str[0] = '\0';
+        }
+        return 0;
+    }
+    if(base == 10) {
+        return format_decimal(str, n, false, val, width);
     }
+    return format_base(str, n, val, base, DIGITS_LOWER, width);
+}
 
-    return (strlcpy(result_str, &buff[i+1], result_size) < result_size);
+size_t int32_array_to_strn(const int32_t *values, size_t count,
+        char *str, size_t n, const char *separator, size_t *len)
+{
+    const size_t separator_len = separator ? strlen(separator) : 0;
+    size_t total = 0;
+    size_t i;
+    for(i=0; i<count; i++) {
+        const bool sign = (values[i] < 0);
+        const uint32_t magnitude = sign
+            ? (0U - (uint32_t)values[i]) : (uint32_t)values[i];
+        if(!append_decimal(str, n, &total, separator,
+                    i ? separator_len : 0, sign, magnitude)) {
+            break;
+        }
+    }
+    return finish_array(str, n, total, len, i);
 }
 
+size_t int64_array_to_strn(const int64_t *values, size_t count,
+        char *str, size_t n, const char *separator, size_t *len)
+{
+    const size_t separator_len = separator ? strlen(separator) : 0;
+    size_t total = 0;
+    size_t i;
+    for(i=0; i<count; i++) {
+        const bool sign = (values[i] < 0);
+        const uint64_t magnitude = sign
+            ? (0ULL - (uint64_t)values[i]) : (uint64_t)values[i];
+        if(!append_decimal(str, n, &total, separator,
+                    i ? separator_len : 0, sign, magnitude)) {
+            break;
+        }
+    }
+    return finish_array(str, n, total, len, i);
+}
@@ -1,5 +1,6 @@
 #include "retry_ringbuffer.h"
 #include <assert.h>
+#include <string.h>
 
 // #include <stdio.h>
 
@@ -28,6 +29,36 @@ void retry_ringbuffer_init(RetryRingbuffer *ctx, Ringbuffer *ringbuffer)
     ctx->next_write = ringbuffer->write;
     ctx->next_read = ringbuffer->read;
     ctx->num_reads = 0;
+    ctx->read_seq = 0;
+    ctx->write_done = NULL;
+    ctx->read_done = NULL;
+    ctx->lease_deadlines = NULL;
+    ctx->lease_clock = NULL;
+    ctx->lease_ticks = 0;
+    ctx->lease_epoch = 0;
+    ctx->drop_policy = RETRY_RINGBUFFER_DROP_OLDEST;
+    retry_ringbuffer_reset_stats(ctx);
+    ctx->claimers = NULL;
+    ctx->claim_epoch = 0;
+}
+
+void retry_ringbuffer_init_unordered(RetryRingbuffer *ctx,
+        Ringbuffer *ringbuffer, uint32_t *write_done, uint32_t *read_done)
+{
+    retry_ringbuffer_init(ctx, ringbuffer);
+
+    const size_t element_count = ringbuffer->num_bytes / ringbuffer->elem_sz;
+    const size_t bitmap_size = RETRY_RINGBUFFER_BITMAP_WORDS(element_count)
+        * sizeof(uint32_t);
+
+    if(write_done) {
+        memset(write_done, 0, bitmap_size);
+    }
+    if(read_done) {
+        memset(read_done, 0, bitmap_size);
+    }
+    ctx->write_done = write_done;
+    ctx->read_done = read_done;
 }
 
 // return the next index relative to the supplied one
@@ -58,6 +89,220 @@ static RingbufferIndex prev_index(const Ringbuffer *ringbuffer,
     return index;
 }
 
+// return the index n elements after the supplied one
+static RingbufferIndex advance_index(const Ringbuffer *ringbuffer,
+        RingbufferIndex index, size_t n)
+{
+    size_t offset = index.offset + (n * ringbuffer->elem_sz);
+
+    // index past end, wrap: toggle wrap bit
+    if(offset >= ringbuffer->num_bytes) {
+        offset-= ringbuffer->num_bytes;
+        index.wrap^=1;
+    }
+    index.offset = offset;
+    return index;
+}
+
+// return the index n elements before the supplied one
+static RingbufferIndex rewind_index(const Ringbuffer *ringbuffer,
+        RingbufferIndex index, size_t n)
+{
+    const size_t bytes = n * ringbuffer->elem_sz;
+
+    // index underflow, undo wrap: toggle wrap bit
+    if(bytes > index.offset) {
+        index.offset = index.offset + ringbuffer->num_bytes - bytes;
+        index.wrap^=1;
+    } else {
+        index.offset = index.offset - bytes;
+    }
+    return index;
+}
+
+// describe count elements starting at index as up to two contiguous regions
+static void fill_spans(const Ringbuffer *ringbuffer, RingbufferIndex index,
+        uint32_t count, RetryRingbufferSpans *spans)
+{
+    const size_t until_end = (ringbuffer->num_bytes - index.offset)
+        / ringbuffer->elem_sz;
+    const uint32_t first = (count < until_end) ? count : until_end;
+
+    spans->ptr[0] = first ? (ringbuffer->first_elem + index.offset) : NULL;
+    spans->count[0] = first;
+    spans->ptr[1] = (count > first) ? ringbuffer->first_elem : NULL;
+    spans->count[1] = count - first;
+}
+
+// return the element number of the slot at the given index
+static size_t slot_of(const Ringbuffer *ringbuffer, RingbufferIndex index)
+{
+    return index.offset / ringbuffer->elem_sz;
+}
+
+// return the amount of elements from 'from' up to (not including) 'to'
+static size_t index_distance(const Ringbuffer *ringbuffer,
+        RingbufferIndex from, RingbufferIndex to)
+{
+    size_t diff = (size_t)to.offset - (size_t)from.offset;
+    if(from.wrap != to.wrap) {
+        diff+= ringbuffer->num_bytes;
+    }
+    return diff / ringbuffer->elem_sz;
+}
+
+// return true if ptr points to an element in the range [from, to)
+static bool index_range_contains(const Ringbuffer *ringbuffer,
+        RingbufferIndex from, RingbufferIndex to, const void *ptr)
+{
+    const uint8_t *elem = ptr;
+    if((elem < ringbuffer->first_elem)
+            || (elem >= (ringbuffer->first_elem + ringbuffer->num_bytes))) {
+        return false;
+    }
+    size_t offset = elem - ringbuffer->first_elem;
+    if(offset < from.offset) {
+        offset+= ringbuffer->num_bytes;
+    }
+    const size_t n = (offset - from.offset) / ringbuffer->elem_sz;
+
+    return (n < index_distance(ringbuffer, from, to));
+}
+
+static bool bitmap_get(const uint32_t *bitmap, size_t slot)
+{
+    return (bitmap[slot / 32] >> (slot % 32)) & 1;
+}
+
+static void bitmap_set(uint32_t *bitmap, size_t slot)
+{
+    bitmap[slot / 32]|= (1UL << (slot % 32));
+}
+
+static void bitmap_clear(uint32_t *bitmap, size_t slot)
+{
+    bitmap[slot / 32]&= ~(1UL << (slot % 32));
+}
+
+// commit all writes that were completed out-of-order,
+// up to the first write that is not yet completed
+static void release_completed_writes(RetryRingbuffer *ctx)
+{
+    Ringbuffer *ring = ctx->ring;
+    if(!ctx->write_done) {
+        return;
+    }
+
+    while(ring->write.raw != ctx->next_write.raw) {
+        const size_t slot = slot_of(ring, ring->write);
+        if(!bitmap_get(ctx->write_done, slot)) {
+            break;
+        }
+        bitmap_clear(ctx->write_done, slot);
+        ringbuffer_commit(ring);
+    }
+}
+
+// advance past all reads that were completed out-of-order,
+// up to the first read that is not yet completed
+static void release_completed_reads(RetryRingbuffer *ctx)
+{
+    Ringbuffer *ring = ctx->ring;
+    if(!ctx->read_done) {
+        return;
+    }
+
+    while(!ringbuffer_is_empty(ring)) {
+        const RingbufferIndex read = ring->read;
+        const size_t slot = slot_of(ring, read);
+        if(!bitmap_get(ctx->read_done, slot)) {
+            break;
+        }
+        bitmap_clear(ctx->read_done, slot);
+
+        // completed element was canceled afterwards: no need to claim it again
+        if(ctx->next_read.raw == read.raw) {
+            ctx->next_read = next_index(ring, read);
+        }
+        ringbuffer_advance(ring);
+        ctx->read_seq++;
+    }
+}
+
+// store the lease deadline for count claimed reads starting at index
+static void start_leases(RetryRingbuffer *ctx, RingbufferIndex index,
+        uint32_t count)
+{
+    const Ringbuffer *ring = ctx->ring;
+    if(!ctx->lease_deadlines) {
+        return;
+    }
+
+    const uint32_t deadline = ctx->lease_clock() + ctx->lease_ticks;
+    for(uint32_t i=0; i<count; i++) {
+        ctx->lease_deadlines[slot_of(ring, index)] = deadline;
+        index = next_index(ring, index);
+    }
+}
+
+// return true if read_ptr is claimed and not yet completed
+static bool read_is_outstanding(const RetryRingbuffer *ctx,
+        const void *read_ptr)
+{
+    const Ringbuffer *ring = ctx->ring;
+    if(!index_range_contains(ring, ring->read, ctx->next_read, read_ptr)) {
+        return false;
+    }
+    if(!ctx->read_done) {
+        return true;
+    }
+    const size_t slot = ((const uint8_t *)read_ptr - ring->first_elem)
+        / ring->elem_sz;
+    return !bitmap_get(ctx->read_done, slot);
+}
+
+void retry_ringbuffer_enable_lease(RetryRingbuffer *ctx, uint32_t *deadlines,
+        uint32_t lease_ticks, RetryRingbufferClock clock)
+{
+    assert(deadlines && clock);
+
+    ctx->lease_clock = clock;
+    ctx->lease_ticks = lease_ticks;
+    ctx->lease_deadlines = deadlines;
+
+    // reads that are already outstanding start their lease now
+    start_leases(ctx, ctx->ring->read,
+            index_distance(ctx->ring, ctx->ring->read, ctx->next_read));
+}
+
+size_t retry_ringbuffer_requeue_expired(RetryRingbuffer *ctx)
+{
+    const Ringbuffer *ring = ctx->ring;
+
+    if(!ctx->lease_deadlines || (ctx->next_read.raw == ring->read.raw)) {
+        return 0;
+    }
+
+    // Reads are claimed in order, and canceled reads are claimed again
+    // later, so deadlines never decrease from the oldest read onwards.
+    // The oldest read is never completed: it would have been released.
+    const uint32_t deadline = ctx->lease_deadlines[slot_of(ring, ring->read)];
+    if((int32_t)(ctx->lease_clock() - deadline) < 0) {
+        return 0;
+    }
+
+    const size_t requeued = ctx->num_reads;
+    retry_ringbuffer_cancel_all_reads(ctx);
+    ctx->lease_epoch++;
+
+    return requeued;
+}
+
+uint32_t retry_ringbuffer_lease_epoch(const RetryRingbuffer *ctx)
+{
+    return ctx->lease_epoch;
+}
+
 // return true if no more writeable space is available for claiming
 inline bool retry_ringbuffer_is_full(RetryRingbuffer *ctx)
 {
@@ -99,25 +344,22 @@ static void *retry_ringbuffer_claim_write_ptr(RetryRingbuffer *ctx)
 }
 
 
-/**
- * Cancel the latest read
- *
- * Cancel reading from the pointer previously claimed with claim_read_ptr().
- *
- * NOTE: cancels (and conpletes) should be done in order: only the latest
- * read (that is not yet canceled or completed) can be canceled.
- * If you want to cancel multiple reads: first cancel the last read,
- * then the one before it, etc.
- *
- * @param read_ptr      read pointer as returned from claim_read_ptr().
- *                      This is used to perform a sanity check: cancels should
- *                      be done in the right order.
- *                      NULL may be passed in case you don't have access to
- *                      the read_ptr. In this case the check is skipped.
- */
-static void retry_ringbuffer_cancel_read(RetryRingbuffer *ctx, const void *read_ptr)
+void retry_ringbuffer_cancel_read(RetryRingbuffer *ctx, const void *read_ptr)
 {
     const Ringbuffer *ring = ctx->ring;
+
+    // reads that are already completed are skipped when claiming:
+    // move back past them to find the latest claimed read
+    if(ctx->read_done) {
+        while(ctx->next_read.raw != ring->read.raw) {
+            const RingbufferIndex prev = prev_index(ring, ctx->next_read);
+            if(!bitmap_get(ctx->read_done, slot_of(ring, prev))) {
+                break;
+            }
+            ctx->next_read = prev;
+        }
+    }
+
     const RingbufferIndex prev = prev_index(ring, ctx->next_read);
 
     // assertion: cannot cancel more reads than claimed
@@ -133,36 +375,49 @@ static void retry_ringbuffer_cancel_read(RetryRingbuffer *ctx, const void *read_
 
 }
 
-/**
- * Complete the latest read
- *
- * Complete reading from the read pointer previously claimed with
- * claim_read_ptr().
- *
- * NOTE: completes (and cancels) should be done in order: only the first
- * read (that is not yet canceled or completed) can be completed.
- * If you want to complete multiple reads: first complete the oldest read,
- * then the one after it, etc.
- *
- * @param read_ptr      read pointer as returned from claim_read_ptr().
- *                      This is used to perform a sanity check: completes
- *                      should be done in the right order.
- *                      NULL may be passed in case you don't have access to
- *                      the read_ptr. In this case the check is skipped.
- */
-static void retry_ringbuffer_complete_read(RetryRingbuffer *ctx, const void *read_ptr)
+void retry_ringbuffer_complete_read(RetryRingbuffer *ctx, const void *read_ptr)
 {
+    Ringbuffer *ring = ctx->ring;
+    const void *oldest = ringbuffer_get_readable(ring);
+
+    // the lease of this read expired, it is handed out again: ignore
+    if(read_ptr && ctx->lease_deadlines
+            && !read_is_outstanding(ctx, read_ptr)) {
+        return;
+    }
+
+    if(read_ptr && ctx->read_done && (read_ptr != oldest)) {
+
+        // assertion: only claimed reads can be completed
+        assert(index_range_contains(ring, ring->read, ctx->next_read,
+                    read_ptr));
+
+        const size_t slot = ((const uint8_t *)read_ptr - ring->first_elem)
+            / ring->elem_sz;
+
+        // assertion: cannot complete the same read twice
+        assert(!bitmap_get(ctx->read_done, slot));
+
+        bitmap_set(ctx->read_done, slot);
+        ctx->num_reads -= 1;
+        return;
+    }
+
     if(read_ptr) {
         // assertion: completed read should be the first non-completed read
-        assert(ringbuffer_get_readable(ctx->ring) == read_ptr);
+        assert(oldest == read_ptr);
     }
 
     // advance: assert the ringbuffer is not empty.
     // the ringbuffer should never be empty at this point,
     // because the read_ptr was claimed earlier.
-    assert(ringbuffer_advance(ctx->ring));
+    const bool advanced = ringbuffer_advance(ring);
+    assert(advanced);
 
+    ctx->read_seq+= advanced;
     ctx->num_reads -= 1;
+
+    release_completed_reads(ctx);
 }
 
 
@@ -188,11 +443,35 @@ void retry_ringbuffer_cancel_write(RetryRingbuffer *ctx, void *write_ptr)
         assert(write_ptr == (ring->first_elem + prev.offset));
     }
 
+    if(ctx->write_done) {
+        // assertion: cannot cancel a write that is already completed
+        assert(!bitmap_get(ctx->write_done, slot_of(ring, prev)));
+    }
+
     ctx->next_write = prev;
 }
 
 void retry_ringbuffer_complete_write(RetryRingbuffer *ctx, void *write_ptr)
 {
+    Ringbuffer *ring = ctx->ring;
+
+    if(write_ptr && ctx->write_done
+            && (write_ptr != (ring->first_elem + ring->write.offset))) {
+
+        // assertion: only claimed writes can be completed
+        assert(index_range_contains(ring, ring->write, ctx->next_write,
+                    write_ptr));
+
+        const size_t slot = ((uint8_t *)write_ptr - ring->first_elem)
+            / ring->elem_sz;
+
+        // assertion: cannot complete the same write twice
+        assert(!bitmap_get(ctx->write_done, slot));
+
+        bitmap_set(ctx->write_done, slot);
+        return;
+    }
+
     if(write_ptr) {
         // assertion: completed write should be the first non-completed write
         assert(ringbuffer_get_writeable(ctx->ring) == write_ptr);
@@ -201,39 +480,478 @@ void retry_ringbuffer_complete_write(RetryRingbuffer *ctx, void *write_ptr)
     // commit: assert the ringbuffer is not full.
     // the ringbuffer should never be full at this point,
     // because the write_ptr was claimed earlier.
-    assert(ringbuffer_commit(ctx->ring));
+    assert(ringbuffer_commit(ring));
+
+    release_completed_writes(ctx);
 }
 
 void *retry_ringbuffer_claim_read_ptr(RetryRingbuffer *ctx)
 {
     Ringbuffer *ring = ctx->ring;
 
-    if(retry_ringbuffer_is_empty(ctx)) {
-        return NULL;
+    retry_ringbuffer_requeue_expired(ctx);
+
+    while(!retry_ringbuffer_is_empty(ctx)) {
+
+        const RingbufferIndex next_r = ctx->next_read;
+        ctx->next_read = next_index(ring, next_r);
+
+        // skip reads that were completed before being canceled
+        if(ctx->read_done
+                && bitmap_get(ctx->read_done, slot_of(ring, next_r))) {
+            continue;
+        }
+
+        ctx->num_reads += 1;
+        start_leases(ctx, next_r, 1);
+
+        // debug(ctx);
+
+        return ring->first_elem + next_r.offset;
     }
+    return NULL;
+}
 
-    const RingbufferIndex next_r = ctx->next_read;
-    ctx->next_read = next_index(ring, next_r);
+uint32_t retry_ringbuffer_claim_reads(RetryRingbuffer *ctx, uint32_t max,
+        RetryRingbufferSpans *spans)
+{
+    Ringbuffer *ring = ctx->ring;
 
-    ctx->num_reads += 1;
+    retry_ringbuffer_requeue_expired(ctx);
 
-    // debug(ctx);
+    // skip reads that were completed before being canceled
+    if(ctx->read_done) {
+        while(!retry_ringbuffer_is_empty(ctx)
+                && bitmap_get(ctx->read_done, slot_of(ring, ctx->next_read))) {
+            ctx->next_read = next_index(ring, ctx->next_read);
+        }
+    }
+
+    const RingbufferIndex first = ctx->next_read;
+    const size_t available = index_distance(ring, first, ring->write);
+    uint32_t count = (max < available) ? max : available;
+
+    // batch ends before the next already completed read
+    if(ctx->read_done) {
+        RingbufferIndex index = first;
+        for(uint32_t i=0; i<count; i++) {
+            if(bitmap_get(ctx->read_done, slot_of(ring, index))) {
+                count = i;
+                break;
+            }
+            index = next_index(ring, index);
+        }
+    }
+
+    fill_spans(ring, first, count, spans);
+    spans->seq = ctx->read_seq + index_distance(ring, ring->read, first);
+    ctx->next_read = advance_index(ring, first, count);
+    ctx->num_reads += count;
+    start_leases(ctx, first, count);
 
-    return ring->first_elem + next_r.offset;
+    return count;
 }
 
-void retry_ringbuffer_complete_all_reads(RetryRingbuffer *ctx)
+// return true if all claimed reads are still outstanding
+static bool reads_in_order(const RetryRingbuffer *ctx)
+{
+    const Ringbuffer *ring = ctx->ring;
+    return (ctx->num_reads == index_distance(ring, ring->read, ctx->next_read));
+}
+
+void retry_ringbuffer_complete_reads(RetryRingbuffer *ctx, uint32_t count)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    // assertion: cannot complete more reads than claimed
+    assert(count <= ctx->num_reads);
+
+    if(!reads_in_order(ctx)) {
+        for(uint32_t i=0; i<count; i++) {
+            retry_ringbuffer_complete_read(ctx, NULL);
+        }
+        return;
+    }
+
+    ring->read = advance_index(ring, ring->read, count);
+    ctx->read_seq+= count;
+    ctx->num_reads -= count;
+
+    release_completed_reads(ctx);
+}
+
+void retry_ringbuffer_cancel_reads(RetryRingbuffer *ctx, uint32_t count)
 {
-    for(size_t i=0; i<ctx->num_reads; i++) {
-        retry_ringbuffer_complete_read(ctx, NULL);
+    // assertion: cannot cancel more reads than claimed
+    assert(count <= ctx->num_reads);
+
+    if(!reads_in_order(ctx)) {
+        for(uint32_t i=0; i<count; i++) {
+            retry_ringbuffer_cancel_read(ctx, NULL);
+        }
+        return;
     }
+
+    ctx->next_read = rewind_index(ctx->ring, ctx->next_read, count);
+    ctx->num_reads -= count;
+}
+
+uint32_t retry_ringbuffer_claim_writes(RetryRingbuffer *ctx, uint32_t max,
+        RetryRingbufferSpans *spans)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    const size_t element_count = ring->num_bytes / ring->elem_sz;
+    const size_t available = element_count
+        - index_distance(ring, ring->read, ctx->next_write);
+    const uint32_t count = (max < available) ? max : available;
+
+    ring->overflow = !available;
+
+    fill_spans(ring, ctx->next_write, count, spans);
+    spans->seq = ctx->read_seq
+        + index_distance(ring, ring->read, ctx->next_write);
+    ctx->next_write = advance_index(ring, ctx->next_write, count);
+
+    return count;
+}
+
+void retry_ringbuffer_complete_writes(RetryRingbuffer *ctx, uint32_t count)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    if(ctx->write_done) {
+        for(uint32_t i=0; i<count; i++) {
+            retry_ringbuffer_complete_write(ctx, NULL);
+        }
+        return;
+    }
+
+    // assertion: cannot complete more writes than claimed
+    assert(count <= index_distance(ring, ring->write, ctx->next_write));
+
+    ring->write = advance_index(ring, ring->write, count);
+}
+
+void retry_ringbuffer_cancel_writes(RetryRingbuffer *ctx, uint32_t count)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    if(ctx->write_done) {
+        for(uint32_t i=0; i<count; i++) {
+            retry_ringbuffer_cancel_write(ctx, NULL);
+        }
+        return;
+    }
+
+    // assertion: cannot cancel more writes than claimed
+    assert(count <= index_distance(ring, ring->write, ctx->next_write));
+
+    ctx->next_write = rewind_index(ring, ctx->next_write, count);
+}
+
+void retry_ringbuffer_complete_all_reads(RetryRingbuffer *ctx)
+{
+    retry_ringbuffer_complete_reads(ctx, ctx->num_reads);
 }
 
 void retry_ringbuffer_cancel_all_reads(RetryRingbuffer *ctx)
 {
-    for(size_t i=0; i<ctx->num_reads; i++) {
-        retry_ringbuffer_cancel_read(ctx, NULL);
+    // completed reads are skipped when claiming again
+    ctx->next_read = ctx->ring->read;
+    ctx->num_reads = 0;
+    ctx->claim_epoch++;
+}
+
+uint64_t retry_ringbuffer_seq(const RetryRingbuffer *ctx, const void *ptr)
+{
+    const Ringbuffer *ring = ctx->ring;
+
+    // assertion: ptr should point to an element in the ringbuffer
+    assert(index_range_contains(ring, ring->read, ctx->next_write, ptr));
+
+    size_t offset = (const uint8_t *)ptr - ring->first_elem;
+    if(offset < ring->read.offset) {
+        offset+= ring->num_bytes;
+    }
+    return ctx->read_seq + ((offset - ring->read.offset) / ring->elem_sz);
+}
+
+// return the amount of elements from the oldest read up to seq,
+// or false if seq was already released
+static bool seq_distance(const RetryRingbuffer *ctx, uint64_t seq, size_t *n)
+{
+    const Ringbuffer *ring = ctx->ring;
+    if(seq < ctx->read_seq) {
+        return false;
+    }
+
+    // assertion: seq should refer to an element that was written
+    const uint64_t distance = seq - ctx->read_seq;
+    const bool written = (distance
+            < index_distance(ring, ring->read, ring->write));
+    assert(written);
+
+    *n = distance;
+    return written;
+}
+
+// return the amount of claimed reads in the first count claimed elements
+// that are not completed yet
+static size_t outstanding_reads(const RetryRingbuffer *ctx,
+        RingbufferIndex index, size_t count)
+{
+    const Ringbuffer *ring = ctx->ring;
+    if(!ctx->read_done || reads_in_order(ctx)) {
+        return count;
     }
+
+    size_t outstanding = 0;
+    for(size_t i=0; i<count; i++) {
+        outstanding+= !bitmap_get(ctx->read_done, slot_of(ring, index));
+        index = next_index(ring, index);
+    }
+    return outstanding;
+}
+
+void retry_ringbuffer_ack_up_to(RetryRingbuffer *ctx, uint64_t seq)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    size_t last;
+    if(!seq_distance(ctx, seq, &last)) {
+        return;
+    }
+    const size_t count = last + 1;
+    const size_t claimed = index_distance(ring, ring->read, ctx->next_read);
+    const size_t acked_claims = (count < claimed) ? count : claimed;
+
+    ctx->num_reads-= outstanding_reads(ctx, ring->read, acked_claims);
+
+    // released slots should not stay marked as completed. This includes
+    // reads that were completed and canceled afterwards (after the window).
+    if(ctx->read_done && ((count > claimed) || !reads_in_order(ctx))) {
+        RingbufferIndex index = ring->read;
+        for(size_t i=0; i<count; i++) {
+            bitmap_clear(ctx->read_done, slot_of(ring, index));
+            index = next_index(ring, index);
+        }
+    }
+
+    ring->read = advance_index(ring, ring->read, count);
+    ctx->read_seq+= count;
+
+    // acked elements that were requeued: no need to claim them again
+    if(count > claimed) {
+        ctx->next_read = ring->read;
+    }
+
+    release_completed_reads(ctx);
+}
+
+void retry_ringbuffer_ack(RetryRingbuffer *ctx, uint64_t seq)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    size_t n;
+    if(!seq_distance(ctx, seq, &n)) {
+        return;
+    }
+    const RingbufferIndex index = advance_index(ring, ring->read, n);
+
+    if(!ctx->read_done) {
+        // assertion: without read_done bitmap, only the oldest can be acked
+        assert(n == 0);
+        retry_ringbuffer_ack_up_to(ctx, seq);
+        return;
+    }
+
+    // duplicate ack
+    if(bitmap_get(ctx->read_done, slot_of(ring, index))) {
+        return;
+    }
+
+    if(n < index_distance(ring, ring->read, ctx->next_read)) {
+        retry_ringbuffer_complete_read(ctx, ring->first_elem + index.offset);
+        return;
+    }
+
+    // not claimed (requeued): mark it so it is skipped when claiming again
+    bitmap_set(ctx->read_done, slot_of(ring, index));
+    release_completed_reads(ctx);
+}
+
+void retry_ringbuffer_nack(RetryRingbuffer *ctx, uint64_t seq)
+{
+    Ringbuffer *ring = ctx->ring;
+
+    size_t n;
+    if(!seq_distance(ctx, seq, &n)) {
+        return;
+    }
+
+    // not claimed, or already requeued
+    const size_t claimed = index_distance(ring, ring->read, ctx->next_read);
+    if(n >= claimed) {
+        return;
+    }
+
+    // go-back-N: seq and all reads claimed after it are handed out again.
+    // Reads completed in the meantime are skipped when claiming again.
+    const RingbufferIndex index = advance_index(ring, ring->read, n);
+    ctx->num_reads-= outstanding_reads(ctx, index, claimed - n);
+    ctx->next_read = index;
+    ctx->claim_epoch++;
+}
+
+// return the index of the element with sequence number seq
+static RingbufferIndex index_of_seq(const RetryRingbuffer *ctx, uint64_t seq)
+{
+    return advance_index(ctx->ring, ctx->ring->read, seq - ctx->read_seq);
+}
+
+// drop the part of the claimer window that is no longer claimed:
+// all of it if the reads were requeued, the oldest part if it was released
+static void claimer_sync(RetryRingbufferClaimer *claimer)
+{
+    const RetryRingbuffer *ctx = claimer->ctx;
+
+    if(claimer->epoch != ctx->claim_epoch) {
+        claimer->count = 0;
+    }
+    if(claimer->count && (claimer->seq < ctx->read_seq)) {
+        const uint64_t released = ctx->read_seq - claimer->seq;
+        const uint32_t dropped = (released < claimer->count)
+            ? released : claimer->count;
+        claimer->seq+= dropped;
+        claimer->count-= dropped;
+    }
+    if(!claimer->count) {
+        claimer->parked = false;
+    }
+}
+
+void retry_ringbuffer_claimer_init(RetryRingbufferClaimer *claimer,
+        RetryRingbuffer *ctx)
+{
+    // assertion: claimers complete out-of-order, this requires read_done
+    assert(ctx->read_done);
+
+    claimer->ctx = ctx;
+    claimer->seq = 0;
+    claimer->count = 0;
+    claimer->epoch = ctx->claim_epoch;
+    claimer->parked = false;
+
+    claimer->next = ctx->claimers;
+    ctx->claimers = claimer;
+}
+
+uint32_t retry_ringbuffer_claimer_claim(RetryRingbufferClaimer *claimer,
+        uint32_t max, RetryRingbufferSpans *spans)
+{
+    RetryRingbuffer *ctx = claimer->ctx;
+
+    retry_ringbuffer_requeue_expired(ctx);
+    claimer_sync(claimer);
+
+    // assertion: a claimer can hold only one window at a time,
+    // a canceled (parked) window is taken back as a whole
+    assert(!claimer->count || (claimer->parked && (claimer->count <= max)));
+
+    // canceled windows are handed out first, as a whole: the claimer's own
+    // window, or else one of another claimer that fits
+    RetryRingbufferClaimer *parked = claimer->parked ? claimer : NULL;
+    for(RetryRingbufferClaimer *other = ctx->claimers; other && !parked;
+            other = other->next) {
+        claimer_sync(other);
+        if(other->parked && (other->count <= max)) {
+            parked = other;
+        }
+    }
+    if(parked) {
+        const uint32_t count = parked->count;
+        fill_spans(ctx->ring, index_of_seq(ctx, parked->seq), count, spans);
+        spans->seq = parked->seq;
+
+        parked->count = 0;
+        parked->parked = false;
+
+        claimer->seq = spans->seq;
+        claimer->count = count;
+        claimer->epoch = ctx->claim_epoch;
+        return count;
+    }
+
+    const uint32_t count = retry_ringbuffer_claim_reads(ctx, max, spans);
+    claimer->seq = spans->seq;
+    claimer->count = count;
+    claimer->epoch = ctx->claim_epoch;
+    return count;
+}
+
+void retry_ringbuffer_claimer_complete(RetryRingbufferClaimer *claimer,
+        uint32_t count)
+{
+    RetryRingbuffer *ctx = claimer->ctx;
+    const Ringbuffer *ring = ctx->ring;
+
+    claimer_sync(claimer);
+
+    // reads that were requeued or released in the meantime are skipped
+    if(count > claimer->count) {
+        count = claimer->count;
+    }
+
+    for(uint32_t i=0; i<count; i++) {
+        const RingbufferIndex index = index_of_seq(ctx, claimer->seq);
+        if(!bitmap_get(ctx->read_done, slot_of(ring, index))) {
+            retry_ringbuffer_complete_read(ctx, ring->first_elem + index.offset);
+        }
+        claimer->seq++;
+        claimer->count--;
+    }
+}
+
+void retry_ringbuffer_claimer_cancel(RetryRingbufferClaimer *claimer)
+{
+    RetryRingbuffer *ctx = claimer->ctx;
+
+    claimer_sync(claimer);
+    if(!claimer->count) {
+        return;
+    }
+
+    // latest window: simply hand it out again from the shared cursor
+    const RingbufferIndex end = index_of_seq(ctx,
+            claimer->seq + claimer->count);
+    if(end.raw == ctx->next_read.raw) {
+        ctx->next_read = index_of_seq(ctx, claimer->seq);
+        ctx->num_reads-= claimer->count;
+        claimer->count = 0;
+        return;
+    }
+
+    // newer reads are claimed: park the window for the next claim.
+    // Parked reads still count as outstanding, so they are never released.
+    claimer->parked = true;
+}
+
+void retry_ringbuffer_set_drop_policy(RetryRingbuffer *ctx,
+        RetryRingbufferDropPolicy policy)
+{
+    ctx->drop_policy = policy;
+}
+
+void retry_ringbuffer_get_stats(const RetryRingbuffer *ctx,
+        RetryRingbufferStats *stats)
+{
+    *stats = ctx->stats;
+}
+
+void retry_ringbuffer_reset_stats(RetryRingbuffer *ctx)
+{
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
 }
 
 void *retry_ringbuffer_wrapping_write_ptr(RetryRingbuffer *ctx)
@@ -241,6 +959,16 @@ void *retry_ringbuffer_wrapping_write_ptr(RetryRingbuffer *ctx)
     void *dst = retry_ringbuffer_claim_write_ptr(ctx);
     if (!dst) {
 
+        // full: the drop policy decides which element is discarded, if any
+        if(ctx->drop_policy == RETRY_RINGBUFFER_BLOCK) {
+            ctx->stats.blocked++;
+            return NULL;
+        }
+        ctx->stats.dropped++;
+        if(ctx->drop_policy == RETRY_RINGBUFFER_DROP_NEWEST) {
+            return NULL;
+        }
+
         // We didn't get a write pointer, this means
         // that the ringbuffer is full. We want to overwrite the oldest entry.
         // However maybe there is already a read pointer given out for this element.
@@ -249,6 +977,8 @@ void *retry_ringbuffer_wrapping_write_ptr(RetryRingbuffer *ctx)
         void *rp = NULL;
         if (ctx->num_reads == 0) {
             rp = retry_ringbuffer_claim_read_ptr(ctx);
+        } else {
+            ctx->stats.dropped_in_flight++;
         }
         retry_ringbuffer_complete_read(ctx, rp);
         dst = retry_ringbuffer_claim_write_ptr(ctx);
@@ -1,11 +1,597 @@
 #include "str.h"
-#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Locale-free string functions for raw (not null-terminated) buffers.
+ *
+ * Bulk work is done 32 bytes at a time with AVX2 or 16 bytes at a time
+ * with SSE2 (if __AVX2__ or __SSE2__ is defined), else 8 bytes at a time
+ * with 64-bit arithmetic (SWAR).
+ * Short tails are handled one byte at a time.
+ */
+
+// Case conversion flips bit 0x20 of the ASCII letters in [first, last].
+// Bytes >= 0x80 (e.g. UTF-8 sequences) are never changed.
+#define CASE_BIT        (0x20)
+
+#define ONES            (0x0101010101010101ULL)
+#define HIGH_BITS       (0x8080808080808080ULL)
+
+// Sets up to this size are searched with one SIMD compare per character,
+// larger sets use a lookup table
+#ifndef STR_FIND_ANY_SIMD_MAX
+#define STR_FIND_ANY_SIMD_MAX   (8)
+#endif
+
+static char char_tolower(char c)
+{
+    return ((c >= 'A') && (c <= 'Z')) ? (c | CASE_BIT) : c;
+}
+
+static bool is_space(char c)
+{
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+}
+
+static uint64_t load_word(const char *str)
+{
+    uint64_t word;
+    memcpy(&word, str, sizeof(word));
+    return word;
+}
+
+// flip the case of the bytes in [first, last]
+static uint64_t word_flip_case(uint64_t word, char first, char last)
+{
+    // per byte: 7 low bits plus an offset never carry into the next
+    // byte, the high bit is set if (byte & 0x7F) >= first (or > last)
+    const uint64_t heptets = word & ~HIGH_BITS;
+    const uint64_t above_first = heptets + ONES * (0x80 - first);
+    const uint64_t above_last = heptets + ONES * (0x80 - last - 1);
+    const uint64_t in_range = above_first & ~above_last & ~word & HIGH_BITS;
+
+    return word ^ (in_range >> 2); // 0x80 >> 2 == CASE_BIT
+}
+
+#if defined(__SSE2__)
+
+static __m128i sse_flip_case(__m128i v, char first, char last)
+{
+    // signed compares: bytes >= 0x80 are negative, never in range
+    const __m128i in_range = _mm_and_si128(
+            _mm_cmpgt_epi8(v, _mm_set1_epi8(first - 1)),
+            _mm_cmplt_epi8(v, _mm_set1_epi8(last + 1)));
+    return _mm_xor_si128(v, _mm_and_si128(in_range,
+                _mm_set1_epi8(CASE_BIT)));
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+static __m256i avx_flip_case(__m256i v, char first, char last)
+{
+    const __m256i in_range = _mm256_and_si256(
+            _mm256_cmpgt_epi8(v, _mm256_set1_epi8(first - 1)),
+            _mm256_cmpgt_epi8(_mm256_set1_epi8(last + 1), v));
+    return _mm256_xor_si256(v, _mm256_and_si256(in_range,
+                _mm256_set1_epi8(CASE_BIT)));
+}
+
+#endif
+
+static void convert_case(char *str, size_t n, char first, char last)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for(; (n - i) >= sizeof(__m256i); i+= sizeof(__m256i)) {
+        const __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        _mm256_storeu_si256((__m256i *)(str + i),
+                avx_flip_case(v, first, last));
+    }
+#endif
+#if defined(__SSE2__)
+    for(; (n - i) >= sizeof(__m128i); i+= sizeof(__m128i)) {
+        const __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+        _mm_storeu_si128((__m128i *)(str + i), sse_flip_case(v, first, last));
+    }
+#endif
+    for(; (n - i) >= sizeof(uint64_t); i+= sizeof(uint64_t)) {
+        const uint64_t word = word_flip_case(load_word(str + i), first, last);
+        memcpy(str + i, &word, sizeof(word));
+    }
+    for(; i<n; i++) {
+        if((str[i] >= first) && (str[i] <= last)) {
+            str[i]^= CASE_BIT;
+        }
+    }
+}
+
+void str_toupper_n(char *str, size_t n)
+{
+    convert_case(str, n, 'a', 'z');
+}
+
+void str_tolower_n(char *str, size_t n)
+{
+    convert_case(str, n, 'A', 'Z');
+}
 
 void str_toupper(char *str)
 {
-    while(*str != '\0') {
-        *str = toupper(*str);
-        str++;
+    str_toupper_n(str, strlen(str));
+}
+
+void str_tolower(char *str)
+{
+    str_tolower_n(str, strlen(str));
+}
+
+// index of the first byte that differs (case-insensitive), n if none
+static size_t first_case_difference(const char *a, const char *b, size_t n)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for(; (n - i) >= sizeof(__m256i); i+= sizeof(__m256i)) {
+        const __m256i va = avx_flip_case(
+                _mm256_loadu_si256((const __m256i *)(a + i)), 'A', 'Z');
+        const __m256i vb = avx_flip_case(
+                _mm256_loadu_si256((const __m256i *)(b + i)), 'A', 'Z');
+        const uint32_t equal = _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(va, vb));
+        if(equal != 0xFFFFFFFF) {
+            return i + __builtin_ctz(~equal);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for(; (n - i) >= sizeof(__m128i); i+= sizeof(__m128i)) {
+        const __m128i va = sse_flip_case(
+                _mm_loadu_si128((const __m128i *)(a + i)), 'A', 'Z');
+        const __m128i vb = sse_flip_case(
+                _mm_loadu_si128((const __m128i *)(b + i)), 'A', 'Z');
+        const unsigned int equal = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+        if(equal != 0xFFFF) {
+            return i + __builtin_ctz(~equal);
+        }
+    }
+#endif
+    for(; (n - i) >= sizeof(uint64_t); i+= sizeof(uint64_t)) {
+        const uint64_t wa = load_word(a + i);
+        const uint64_t wb = load_word(b + i);
+        // exact match is the common case, else compare folded words
+        if((wa != wb) && (word_flip_case(wa, 'A', 'Z')
+                    != word_flip_case(wb, 'A', 'Z'))) {
+            break;
+        }
+    }
+    for(; i<n; i++) {
+        if(char_tolower(a[i]) != char_tolower(b[i])) {
+            return i;
+        }
+    }
+    return n;
+}
+
+int str_casecmp_n(const char *a, const char *b, size_t n)
+{
+    const size_t i = first_case_difference(a, b, n);
+    if(i == n) {
+        return 0;
+    }
+    return (int)(unsigned char)char_tolower(a[i])
+        - (int)(unsigned char)char_tolower(b[i]);
+}
+
+bool str_caseeq_n(const char *a, size_t a_len, const char *b, size_t b_len)
+{
+    return (a_len == b_len) && (first_case_difference(a, b, a_len) == a_len);
+}
+
+// byte lookup table for a set of characters, one bit per byte value
+typedef struct {
+    uint32_t bits[256 / 32];
+} CharSet;
+
+static void char_set_init(CharSet *set, const char *chars, size_t n)
+{
+    memset(set, 0, sizeof(*set));
+    for(size_t i=0; i<n; i++) {
+        const unsigned char c = chars[i];
+        set->bits[c / 32]|= (1UL << (c % 32));
+    }
+}
+
+static bool char_set_contains(const CharSet *set, char c)
+{
+    const unsigned char u = c;
+    return (set->bits[u / 32] >> (u % 32)) & 1;
+}
+
+const char *str_find_any(const char *str, size_t n,
+        const char *set, size_t set_len)
+{
+    if(set_len == 1) {
+        // plain byte search: libc is hard to beat
+        return memchr(str, set[0], n);
+    }
+    size_t i = 0;
+#if defined(__SSE2__)
+    // compare each block with every character of a small set
+    if(set_len <= STR_FIND_ANY_SIMD_MAX) {
+        __m128i needles[STR_FIND_ANY_SIMD_MAX];
+        for(size_t s=0; s<set_len; s++) {
+            needles[s] = _mm_set1_epi8(set[s]);
+        }
+#if defined(__AVX2__)
+        for(; (n - i) >= sizeof(__m256i); i+= sizeof(__m256i)) {
+            const __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+            __m256i found = _mm256_setzero_si256();
+            for(size_t s=0; s<set_len; s++) {
+                found = _mm256_or_si256(found, _mm256_cmpeq_epi8(v,
+                            _mm256_broadcastsi128_si256(needles[s])));
+            }
+            const uint32_t mask = _mm256_movemask_epi8(found);
+            if(mask) {
+                return str + i + __builtin_ctz(mask);
+            }
+        }
+#endif
+        for(; (n - i) >= sizeof(__m128i); i+= sizeof(__m128i)) {
+            const __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+            __m128i found = _mm_setzero_si128();
+            for(size_t s=0; s<set_len; s++) {
+                found = _mm_or_si128(found, _mm_cmpeq_epi8(v, needles[s]));
+            }
+            const unsigned int mask = _mm_movemask_epi8(found);
+            if(mask) {
+                return str + i + __builtin_ctz(mask);
+            }
+        }
+    }
+#endif
+    if((n - i) >= sizeof(uint64_t)) {
+        CharSet lookup;
+        char_set_init(&lookup, set, set_len);
+        for(; i<n; i++) {
+            if(char_set_contains(&lookup, str[i])) {
+                return str + i;
+            }
+        }
+    } else {
+        // a few bytes left: not worth building the table
+        for(; i<n; i++) {
+            if(memchr(set, str[i], set_len)) {
+                return str + i;
+            }
+        }
+    }
+    return NULL;
+}
+
+const char *str_trim(const char *str, size_t n, size_t *len)
+{
+    size_t start = 0;
+    while((start < n) && is_space(str[start])) {
+        start++;
+    }
+    size_t end = n;
+    while((end > start) && is_space(str[end - 1])) {
+        end--;
+    }
+    *len = end - start;
+    return str + start;
+}
+
+void str_split_init(StrSplit *split, const char *str, size_t n,
+        const char *delimiters, size_t delimiters_len)
+{
+    split->str = str;
+    split->len = n;
+    split->pos = 0;
+    split->delimiters = delimiters;
+    split->delimiters_len = delimiters_len;
+    split->done = false;
+}
+
+bool str_split_next(StrSplit *split, const char **token, size_t *token_len)
+{
+    if(split->done) {
+        return false;
+    }
+    const char *start = split->str + split->pos;
+    const size_t left = split->len - split->pos;
+    const char *delimiter = str_find_any(start, left,
+            split->delimiters, split->delimiters_len);
+
+    *token = start;
+    if(delimiter) {
+        *token_len = delimiter - start;
+        split->pos+= *token_len + 1;
+    } else {
+        // the last token ends at the end of the input
+        *token_len = left;
+        split->pos = split->len;
+        split->done = true;
+    }
+    return true;
+}
+
+
+//
+// UTF-8
+//
+
+bool str_is_ascii(const char *str, size_t n)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i any = _mm_setzero_si128();
+    for(; (n - i) >= sizeof(__m128i); i+= sizeof(__m128i)) {
+        any = _mm_or_si128(any, _mm_loadu_si128((const __m128i *)(str + i)));
+    }
+    if(_mm_movemask_epi8(any)) {
+        return false;
+    }
+#endif
+    uint64_t any_word = 0;
+    for(; (n - i) >= sizeof(uint64_t); i+= sizeof(uint64_t)) {
+        any_word|= load_word(str + i);
+    }
+    for(; i<n; i++) {
+        any_word|= (unsigned char)str[i];
+    }
+    return !(any_word & HIGH_BITS);
+}
+
+// Scalar validation, one code point at a time. The state is kept in a
+// Utf8Validator, so a sequence may be split over several calls.
+static bool utf8_validate_bytes(Utf8Validator *v, const char *str, size_t n)
+{
+    for(size_t i=0; i<n; i++) {
+        const unsigned char c = str[i];
+
+        if(v->remaining) {
+            // continuation byte, the first one may have a smaller range
+            if((c < v->min) || (c > v->max)) {
+                return false;
+            }
+            v->min = 0x80;
+            v->max = 0xBF;
+            v->remaining--;
+            continue;
+        }
+
+        if(c < 0x80) {
+            // skip ASCII runs a word at a time
+            while(((n - i) > sizeof(uint64_t))
+                    && !(load_word(str + i + 1) & HIGH_BITS)) {
+                i+= sizeof(uint64_t);
+            }
+            continue;
+        }
+
+        // lead byte: the range of the second byte excludes overlong
+        // encodings, surrogates and code points above U+10FFFF
+        v->min = 0x80;
+        v->max = 0xBF;
+        if((c >= 0xC2) && (c <= 0xDF)) {
+            v->remaining = 1;
+        } else if((c >= 0xE0) && (c <= 0xEF)) {
+            v->remaining = 2;
+            if(c == 0xE0) {
+                v->min = 0xA0;
+            } else if(c == 0xED) {
+                v->max = 0x9F;
+            }
+        } else if((c >= 0xF0) && (c <= 0xF4)) {
+            v->remaining = 3;
+            if(c == 0xF0) {
+                v->min = 0x90;
+            } else if(c == 0xF4) {
+                v->max = 0x8F;
+            }
+        } else {
+            return false;
+        }
     }
+    return true;
 }
 
+#if defined(__SSSE3__)
+
+// Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per
+// Byte", 2021: every error shows up in the high and low nibble of a byte
+// and the high nibble of the next byte, found with three table lookups.
+#define TOO_SHORT       (1 << 0)    // lead byte followed by a non-continuation
+#define TOO_LONG        (1 << 1)    // ASCII followed by a continuation
+#define OVERLONG_3      (1 << 2)
+#define TOO_LARGE       (1 << 3)
+#define SURROGATE       (1 << 4)
+#define OVERLONG_2      (1 << 5)
+#define TOO_LARGE_1000  (1 << 6)
+#define OVERLONG_4      (1 << 6)
+#define TWO_CONTS       (1 << 7)    // two continuations, must be 3rd/4th byte
+#define CARRY           (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+static __m128i high_nibbles(__m128i v)
+{
+    return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+static __m128i check_special_cases(__m128i input, __m128i prev1)
+{
+    const __m128i byte_1_high = _mm_setr_epi8(
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2,
+            TOO_SHORT,
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+    const __m128i byte_1_low = _mm_setr_epi8(
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+            CARRY | OVERLONG_2,
+            CARRY,
+            CARRY,
+            CARRY | TOO_LARGE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000);
+    const __m128i byte_2_high = _mm_setr_epi8(
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3
+                | TOO_LARGE_1000 | OVERLONG_4),
+            (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3
+                | TOO_LARGE),
+            (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE
+                | TOO_LARGE),
+            (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE
+                | TOO_LARGE),
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+    const __m128i low_mask = _mm_set1_epi8(0x0F);
+    return _mm_and_si128(_mm_and_si128(
+                _mm_shuffle_epi8(byte_1_high, high_nibbles(prev1)),
+                _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, low_mask))),
+            _mm_shuffle_epi8(byte_2_high, high_nibbles(input)));
+}
+
+// the errors of a block, given the previous block
+static __m128i check_block(__m128i input, __m128i prev_input)
+{
+    const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+    const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+    const __m128i special = check_special_cases(input, prev1);
+
+    // two continuations in a row are only valid as the 3rd/4th byte
+    const __m128i is_third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    const __m128i is_fourth = _mm_subs_epu8(prev3,
+            _mm_set1_epi8((char)(0xF0 - 0x80)));
+    const __m128i must_be_23 = _mm_and_si128(_mm_or_si128(is_third,
+                is_fourth), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must_be_23, special);
+}
+
+// non-zero if the block ends in the middle of a sequence
+static __m128i check_incomplete(__m128i input)
+{
+    const __m128i max = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, (char)(0xF0 - 1), (char)(0xE0 - 1),
+            (char)(0xC0 - 1));
+    return _mm_subs_epu8(input, max);
+}
+
+static bool utf8_validate_simd(const char *str, size_t n)
+{
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+
+    for(size_t i=0; i<n; i+= sizeof(__m128i)) {
+        __m128i input;
+        if((n - i) >= sizeof(__m128i)) {
+            input = _mm_loadu_si128((const __m128i *)(str + i));
+        } else {
+            // zero padding is ASCII, which ends any sequence
+            char tail[sizeof(__m128i)] = {0};
+            memcpy(tail, str + i, n - i);
+            input = _mm_loadu_si128((const __m128i *)tail);
+        }
+
+        if(!_mm_movemask_epi8(input)) {
+            // ASCII: only a sequence left open by the previous block fails
+            error = _mm_or_si128(error, prev_incomplete);
+        } else {
+            error = _mm_or_si128(error, check_block(input, prev_input));
+            prev_incomplete = check_incomplete(input);
+        }
+        prev_input = input;
+    }
+    error = _mm_or_si128(error, prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()))
+        == 0xFFFF;
+}
+
+#endif
+
+bool str_utf8_validate(const char *str, size_t n)
+{
+#if defined(__SSSE3__)
+    return utf8_validate_simd(str, n);
+#else
+    Utf8Validator v;
+    str_utf8_validator_init(&v);
+    return utf8_validate_bytes(&v, str, n) && str_utf8_validator_finish(&v);
+#endif
+}
+
+void str_utf8_validator_init(Utf8Validator *v)
+{
+    v->remaining = 0;
+    v->min = 0x80;
+    v->max = 0xBF;
+    v->valid = true;
+}
+
+// length of the incomplete sequence at the end of str, 0 if none
+static size_t incomplete_tail(const char *str, size_t n)
+{
+    // a sequence is at most 4 bytes: look at the last 3 for a lead byte
+    for(size_t back=1; (back <= 3) && (back <= n); back++) {
+        const unsigned char c = str[n - back];
+        if((c & 0xC0) != 0x80) {
+            const size_t len = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3
+                : (c >= 0xC0) ? 2 : 1;
+            return (len > back) ? back : 0;
+        }
+    }
+    return 0;
+}
+
+bool str_utf8_validator_update(Utf8Validator *v, const char *str, size_t n)
+{
+    if(!v->valid) {
+        return false;
+    }
+
+    // finish a sequence that started in a previous span
+    size_t i = 0;
+    while(v->remaining && (i < n)) {
+        if(!utf8_validate_bytes(v, str + i, 1)) {
+            v->valid = false;
+            return false;
+        }
+        i++;
+    }
+
+    // whole sequences in bulk, then keep the state of the unfinished one
+    const size_t tail = incomplete_tail(str + i, n - i);
+    const size_t bulk = n - i - tail;
+    v->valid = str_utf8_validate(str + i, bulk)
+        && utf8_validate_bytes(v, str + i + bulk, tail);
+    return v->valid;
+}
+
+bool str_utf8_validator_finish(const Utf8Validator *v)
+{
+    return v->valid && !v->remaining;
+}
@@ -0,0 +1,109 @@
+#include "str_builder.h"
+#include "assert.h"
+#include "long_long_to_str.h"
+#include "f2strn.h"
+#include <string.h>
+
+void str_builder_init(StrBuilder *sb, char *buffer, size_t size)
+{
+    assert(buffer && size);
+    sb->buffer = buffer;
+    sb->size = size;
+    str_builder_reset(sb);
+}
+
+void str_builder_reset(StrBuilder *sb)
+{
+    sb->len = 0;
+    sb->truncated = false;
+    sb->buffer[0] = '\0';
+}
+
+// Space left for an append, including the terminator. 0 if truncated.
+static size_t space_left(const StrBuilder *sb)
+{
+    return sb->truncated ? 0 : (sb->size - sb->len);
+}
+
+// Account for an append that wrote 'len' characters, or as many as fit
+// (formatters return the full length like snprintf).
+static bool commit(StrBuilder *sb, size_t len)
+{
+    if(sb->truncated) {
+        return false;
+    }
+    if(len >= (sb->size - sb->len)) {
+        sb->len = sb->size - 1;
+        sb->truncated = true;
+        return false;
+    }
+    sb->len+= len;
+    return true;
+}
+
+bool str_builder_append_strn(StrBuilder *sb, const char *str, size_t n)
+{
+    const size_t space = space_left(sb);
+    if(!space) {
+        return false;
+    }
+    const size_t copy = (n < space) ? n : (space - 1);
+    memcpy(sb->buffer + sb->len, str, copy);
+    sb->buffer[sb->len + copy] = '\0';
+    return commit(sb, n);
+}
+
+bool str_builder_append_str(StrBuilder *sb, const char *str)
+{
+    return str_builder_append_strn(sb, str, strlen(str));
+}
+
+bool str_builder_append_char(StrBuilder *sb, char c)
+{
+    return str_builder_append_strn(sb, &c, 1);
+}
+
+bool str_builder_append_int(StrBuilder *sb, long long val)
+{
+    const size_t space = space_left(sb);
+    if(!space) {
+        return false;
+    }
+    return commit(sb, long_long_to_strn(sb->buffer + sb->len, space, val));
+}
+
+bool str_builder_append_float(StrBuilder *sb, float val, unsigned int num_dec)
+{
+    const size_t space = space_left(sb);
+    if(!space) {
+        return false;
+    }
+    return commit(sb, f2strn_fixed(val, sb->buffer + sb->len, space,
+                num_dec));
+}
+
+bool str_builder_append_hex(StrBuilder *sb, unsigned long long val,
+        unsigned int width, bool uppercase)
+{
+    const size_t space = space_left(sb);
+    if(!space) {
+        return false;
+    }
+    return commit(sb, ulong_long_to_hex_strn(sb->buffer + sb->len, space,
+                val, width, uppercase));
+}
+
+const char *str_builder_str(const StrBuilder *sb)
+{
+    return sb->buffer;
+}
+
+size_t str_builder_len(const StrBuilder *sb)
+{
+    return sb->len;
+}
+
+bool str_builder_is_truncated(const StrBuilder *sb)
+{
+    return sb->truncated;
+}
@@ -0,0 +1,170 @@
+#include "str_intern.h"
+#include "str.h"
+#include "assert.h"
+#include <string.h>
+
+// bytes hashed per step, and case-folded per call of str_tolower_n()
+#define WORD_SIZE       (sizeof(uint64_t))
+#define FOLD_CHUNK      (64)
+
+#define HASH_MULTIPLIER (0x9E3779B97F4A7C15ULL)
+
+static uint64_t hash_word(uint64_t h, uint64_t word)
+{
+    h = (h ^ word) * HASH_MULTIPLIER;
+    return h ^ (h >> 32);
+}
+
+static uint64_t load_word(const char *str)
+{
+    uint64_t word;
+    memcpy(&word, str, WORD_SIZE);
+    return word;
+}
+
+// hash n bytes, 8 at a time
+static uint64_t hash_bytes(uint64_t h, const char *str, size_t n)
+{
+    if(n < WORD_SIZE) {
+        uint64_t word = 0;
+        for(size_t i=0; i<n; i++) {
+            word = (word << 8) | (unsigned char)str[i];
+        }
+        return hash_word(h, word);
+    }
+    size_t i = 0;
+    for(; (n - i) > WORD_SIZE; i+= WORD_SIZE) {
+        h = hash_word(h, load_word(str + i));
+    }
+    // the last word overlaps the previous one, instead of zero padding
+    return hash_word(h, load_word(str + n - WORD_SIZE));
+}
+
+static uint32_t hash_string(const char *str, size_t n, bool ignore_case)
+{
+    // the length is part of the seed: different lengths never share
+    // their padding or overlap
+    uint64_t h = HASH_MULTIPLIER * (n + 1);
+    if(!ignore_case) {
+        h = hash_bytes(h, str, n);
+    } else {
+        // fold a copy to lowercase, a chunk at a time
+        char folded[FOLD_CHUNK];
+        for(size_t i=0; i<n; i+= FOLD_CHUNK) {
+            const size_t len = ((n - i) < FOLD_CHUNK) ? (n - i) : FOLD_CHUNK;
+            memcpy(folded, str + i, len);
+            str_tolower_n(folded, len);
+            h = hash_bytes(h, folded, len);
+        }
+    }
+    h^= h >> 29;
+    return (uint32_t)h;
+}
+
+static bool entry_equals(const StrIntern *table, const StrInternEntry *entry,
+        const char *str, size_t n)
+{
+    if(entry->len != n) {
+        return false;
+    }
+    const char *stored = table->pool + entry->offset;
+    return table->ignore_case ? str_caseeq_n(stored, n, str, n)
+        : !memcmp(stored, str, n);
+}
+
+// Find the slot of a string, or the empty slot where it would be added
+static StrInternSlot *find_slot(const StrIntern *table, const char *str,
+        size_t n, uint32_t hash)
+{
+    uint32_t index = hash & table->slot_mask;
+    for(;;) {
+        StrInternSlot *slot = &table->slots[index];
+        if(!slot->id_plus_one) {
+            return slot;
+        }
+        if((slot->hash == hash) && entry_equals(table,
+                    &table->entries[slot->id_plus_one - 1], str, n)) {
+            return slot;
+        }
+        index = (index + 1) & table->slot_mask;
+    }
+}
+
+void str_intern_init(StrIntern *table,
+        StrInternSlot *slots, size_t slot_count,
+        StrInternEntry *entries, size_t max_count,
+        char *pool, size_t pool_size, bool ignore_case)
+{
+    // a power of two, with at least one slot that stays empty
+    assert(slot_count && !(slot_count & (slot_count - 1)));
+    assert(max_count < slot_count);
+    // offsets, lengths and IDs are stored as 32 bits
+    assert((uint64_t)slot_count <= UINT32_MAX);
+    assert((uint64_t)pool_size <= UINT32_MAX);
+
+    table->slots = slots;
+    table->slot_mask = slot_count - 1;
+    table->entries = entries;
+    table->max_count = max_count;
+    table->pool = pool;
+    table->pool_size = pool_size;
+    table->ignore_case = ignore_case;
+    str_intern_clear(table);
+}
+
+void str_intern_clear(StrIntern *table)
+{
+    memset(table->slots, 0, (table->slot_mask + 1) * sizeof(StrInternSlot));
+    table->count = 0;
+    table->pool_used = 0;
+}
+
+uint32_t str_intern(StrIntern *table, const char *str, size_t n)
+{
+    const uint32_t hash = hash_string(str, n, table->ignore_case);
+    StrInternSlot *slot = find_slot(table, str, n, hash);
+    if(slot->id_plus_one) {
+        return slot->id_plus_one - 1;
+    }
+
+    // new string: copy it to the pool, with a terminator
+    if((table->count >= table->max_count)
+            || (n >= (table->pool_size - table->pool_used))) {
+        return STR_INTERN_NONE;
+    }
+    const uint32_t id = table->count++;
+    StrInternEntry *entry = &table->entries[id];
+    entry->offset = table->pool_used;
+    entry->len = n;
+    memcpy(table->pool + table->pool_used, str, n);
+    table->pool[table->pool_used + n] = '\0';
+    table->pool_used+= n + 1;
+
+    slot->hash = hash;
+    slot->id_plus_one = id + 1;
+    return id;
+}
+
+uint32_t str_intern_find(const StrIntern *table, const char *str, size_t n)
+{
+    const uint32_t hash = hash_string(str, n, table->ignore_case);
+    const StrInternSlot *slot = find_slot(table, str, n, hash);
+    return slot->id_plus_one ? (slot->id_plus_one - 1) : STR_INTERN_NONE;
+}
+
+const char *str_intern_get(const StrIntern *table, uint32_t id, size_t *len)
+{
+    if(id >= table->count) {
+        return NULL;
+    }
+    const StrInternEntry *entry = &table->entries[id];
+    if(len) {
+        *len = entry->len;
+    }
+    return table->pool + entry->offset;
+}
+
+size_t str_intern_count(const StrIntern *table)
+{
+    return table->count;
+}
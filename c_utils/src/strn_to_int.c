@@ -0,0 +1,157 @@
+#include "strn_to_int.h"
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * Decimal string to integer.
+ *
+ * Eight digits are loaded as one 64-bit word, checked with a few masks and
+ * combined into a number with three multiplications (SWAR, as described
+ * by Daniel Lemire, "Number Parsing at a Gigabyte per Second", 2021).
+ * Shorter tails are read one digit at a time.
+ */
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define STRN_TO_INT_SWAR    (1)
+#else
+#define STRN_TO_INT_SWAR    (0)
+#endif
+
+#define SWAR_DIGITS         (8)
+#define SWAR_SCALE          (100000000ULL)  // 10^SWAR_DIGITS
+
+typedef enum {
+    PARSE_NONE,         // no digits
+    PARSE_OK,
+    PARSE_OVERFLOW,     // more than UINT64_MAX
+} ParseStatus;
+
+static bool is_digit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+#if STRN_TO_INT_SWAR
+
+static uint64_t load_8(const char *str)
+{
+    uint64_t word;
+    memcpy(&word, str, sizeof(word));
+    return word;
+}
+
+// true if all 8 bytes are '0'..'9'
+static bool is_8_digits(uint64_t word)
+{
+    // high nibbles must be 3, adding 6 to the low nibble must not carry
+    return (((word & 0xF0F0F0F0F0F0F0F0ULL)
+                | (((word + 0x0606060606060606ULL)
+                        & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+            == 0x3333333333333333ULL);
+}
+
+// value of 8 digits, first digit in the lowest byte
+static uint32_t parse_8_digits(uint64_t word)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    word-= 0x3030303030303030ULL;
+    // combine neighbouring digits into pairs, then pairs into 4 digits
+    word = (word * 10) + (word >> 8);
+    word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+    return word;
+}
+
+#endif
+
+// parse the digits at str[*pos], up to n. On success, *pos is advanced
+// past the last digit.
+static ParseStatus parse_digits(const char *str, size_t n, size_t *pos,
+        uint64_t *result)
+{
+    size_t i = *pos;
+    uint64_t v = 0;
+
+#if STRN_TO_INT_SWAR
+    while((n - i) >= SWAR_DIGITS) {
+        const uint64_t word = load_8(str + i);
+        if(!is_8_digits(word)) {
+            break;
+        }
+        const uint32_t chunk = parse_8_digits(word);
+        // exact: v * 10^8 + chunk <= UINT64_MAX (a division by a constant
+        // is a multiplication)
+        if(v > ((UINT64_MAX - chunk) / SWAR_SCALE)) {
+            return PARSE_OVERFLOW;
+        }
+        v = (v * SWAR_SCALE) + chunk;
+        i+= SWAR_DIGITS;
+    }
+#endif
+
+    for(; (i < n) && is_digit(str[i]); i++) {
+        const uint32_t digit = str[i] - '0';
+        if(v > ((UINT64_MAX - digit) / 10)) {
+            return PARSE_OVERFLOW;
+        }
+        v = (v * 10) + digit;
+    }
+
+    if(i == *pos) {
+        return PARSE_NONE;
+    }
+    *pos = i;
+    *result = v;
+    return PARSE_OK;
+}
+
+size_t strn_to_u64(const char *str, size_t n, uint64_t *result)
+{
+    size_t pos = 0;
+    if(n && (str[0] == '+')) {
+        pos++;
+    }
+
+    uint64_t v;
+    switch(parse_digits(str, n, &pos, &v)) {
+        case PARSE_OK:
+            *result = v;
+            return pos;
+        case PARSE_OVERFLOW:
+            *result = UINT64_MAX;
+            return 0;
+        default:
+            *result = 0;
+            return 0;
+    }
+}
+
+size_t strn_to_i64(const char *str, size_t n, int64_t *result)
+{
+    size_t pos = 0;
+    bool negative = false;
+    if(n && ((str[0] == '+') || (str[0] == '-'))) {
+        negative = (str[0] == '-');
+        pos++;
+    }
+
+    // the magnitude of INT64_MIN is one more than INT64_MAX
+    const uint64_t limit = (uint64_t)INT64_MAX + negative;
+
+    uint64_t v;
+    const ParseStatus status = parse_digits(str, n, &pos, &v);
+    if((status == PARSE_OVERFLOW)
+            || ((status == PARSE_OK) && (v > limit))) {
+        *result = negative ? INT64_MIN : INT64_MAX;
+        return 0;
+    }
+    if(status == PARSE_NONE) {
+        *result = 0;
+        return 0;
+    }
+
+    // negate as unsigned: also correct for INT64_MIN
+    *result = negative ? (int64_t)(0ULL - v) : (int64_t)v;
+    return pos;
+}
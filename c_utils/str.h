@@ -1,13 +1,167 @@
 #ifndef STR_H
 #define STR_H
 
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Locale-free string functions.
+ *
+ * Except for str_toupper() and str_tolower(), the inputs do not have to
+ * be null-terminated: every function takes a length, and '\0' is not
+ * special. They work directly on e.g. ringbuffer or receive buffers
+ * and never allocate. Case-insensitive means ASCII only (like the
+ * "C" locale): bytes >= 0x80 are compared as-is.
+ */
+
 /**
  * Convert a string to uppercase.
  *
  * Note: the input string is converted in-place.
  * Make sure the input is a valid c-style string.
+ * Only ASCII letters are converted (like toupper() in the "C" locale),
+ * see str_toupper_n().
  */
 void str_toupper(char *str);
 
-#endif
+/**
+ * Convert a string to lowercase, see str_toupper().
+ */
+void str_tolower(char *str);
+
+/**
+ * Convert the first n characters of str to uppercase, in-place.
+ *
+ * The input does not have to be null-terminated: exactly n characters are
+ * converted, '\0' is not special. Only 'a'-'z' are changed, other bytes
+ * (including UTF-8 sequences) are left as-is.
+ * Works on 8 bytes at a time (16 with SSE2).
+ */
+void str_toupper_n(char *str, size_t n);
+
+/**
+ * Convert the first n characters of str to lowercase, see str_toupper_n().
+ */
+void str_tolower_n(char *str, size_t n);
+
+/**
+ * Case-insensitive compare of exactly n characters.
+ *
+ * @return  <0, 0 or >0 like memcmp(), after converting both to lowercase
+ */
+int str_casecmp_n(const char *a, const char *b, size_t n);
+
+/**
+ * Case-insensitive equality of two strings with a length
+ * (e.g. a header key against a known name).
+ */
+bool str_caseeq_n(const char *a, size_t a_len, const char *b, size_t b_len);
+
+/**
+ * Find the first of the first n characters of str that is in 'set'
+ * (e.g. the first of several delimiters), like strpbrk().
+ *
+ * @param set       set_len characters to search for
+ *
+ * @return          pointer to the first match, or NULL if there is none
+ */
+const char *str_find_any(const char *str, size_t n,
+        const char *set, size_t set_len);
+
+/**
+ * Skip leading and trailing whitespace (" \t\n\v\f\r").
+ *
+ * @param len       the length of the trimmed string
+ *
+ * @return          start of the trimmed string inside str
+ */
+const char *str_trim(const char *str, size_t n, size_t *len);
+
 
+/**
+ * Iterate over the tokens of a string, separated by any of a set of
+ * delimiters. Like strsep(), every delimiter ends a token, so empty tokens
+ * are returned as well: "a,,b" gives "a", "" and "b". The input is not
+ * modified.
+ *
+ * Usage:
+ *  StrSplit split;
+ *  str_split_init(&split, line, line_len, ",;", 2);
+ *  const char *token;
+ *  size_t token_len;
+ *  while(str_split_next(&split, &token, &token_len)) {
+ *      ...
+ *  }
+ */
+typedef struct {
+    const char *str;
+    size_t len;
+    size_t pos;
+    const char *delimiters;
+    size_t delimiters_len;
+    bool done;
+} StrSplit;
+
+void str_split_init(StrSplit *split, const char *str, size_t n,
+        const char *delimiters, size_t delimiters_len);
+
+/**
+ * Get the next token, see StrSplit.
+ *
+ * @return  false if there are no more tokens
+ */
+bool str_split_next(StrSplit *split, const char **token, size_t *token_len);
+
+
+/**
+ * Check if the first n characters of str are all ASCII (< 0x80).
+ */
+bool str_is_ascii(const char *str, size_t n);
+
+/**
+ * Check if the first n characters of str are valid UTF-8: no overlong
+ * encodings, surrogates, code points above U+10FFFF or incomplete
+ * sequences (RFC 3629).
+ *
+ * With SSSE3 (or AVX2), 16 bytes at a time are checked with the
+ * Keiser-Lemire algorithm. Else ASCII runs are skipped 8 bytes at a time.
+ */
+bool str_utf8_validate(const char *str, size_t n);
+
+
+/**
+ * Validate UTF-8 that is split over several spans, e.g. the two parts of
+ * a ringbuffer that wrapped, without copying. A sequence may be split
+ * between spans.
+ *
+ * Usage:
+ *  Utf8Validator v;
+ *  str_utf8_validator_init(&v);
+ *  str_utf8_validator_update(&v, first_part, first_len);
+ *  str_utf8_validator_update(&v, second_part, second_len);
+ *  if(str_utf8_validator_finish(&v)) {
+ *      ...valid UTF-8
+ *  }
+ */
+typedef struct {
+    unsigned char remaining;    // continuation bytes still expected
+    unsigned char min;          // allowed range of the next continuation
+    unsigned char max;
+    bool valid;                 // no error found so far
+} Utf8Validator;
+
+void str_utf8_validator_init(Utf8Validator *v);
+
+/**
+ * Validate the next span.
+ *
+ * @return  false if the input so far is not valid UTF-8 (sticky)
+ */
+bool str_utf8_validator_update(Utf8Validator *v, const char *str, size_t n);
+
+/**
+ * @return  true if all spans together are valid UTF-8, with no sequence
+ *          left incomplete at the end
+ */
+bool str_utf8_validator_finish(const Utf8Validator *v);
+
+#endif
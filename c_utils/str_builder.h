@@ -0,0 +1,107 @@
+#ifndef STR_BUILDER_H
+#define STR_BUILDER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// forward declaration, see end of file
+typedef struct str_builder StrBuilder;
+
+/*
+ * StrBuilder: build a string (e.g. a log or metrics line) piece by piece in
+ * a caller-provided buffer, without format strings or allocation.
+ *
+ * The length is tracked, so every append only costs the length of what is
+ * appended. The string is always null-terminated.
+ * If an append does not fit, as much as fits is written and the builder
+ * is marked as truncated. This is sticky: all further appends are ignored,
+ * so the result is always a prefix of the intended string.
+ *
+ * Usage:
+ *  char line[64];
+ *  StrBuilder sb;
+ *  str_builder_init(&sb, line, sizeof(line));
+ *  str_builder_append_str(&sb, "temp=");
+ *  str_builder_append_float(&sb, temperature, 2);
+ *  str_builder_append_char(&sb, '\n');
+ *  if(!str_builder_is_truncated(&sb)) {
+ *      send(str_builder_str(&sb), str_builder_len(&sb));
+ *  }
+ */
+
+
+/**
+ * Initialize a StrBuilder to an empty string.
+ *
+ * @param buffer    Memory for the string. It should stay valid as long as
+ *                  the builder is used.
+ * @param size      Size of the buffer, including the terminator. At least 1.
+ */
+void str_builder_init(StrBuilder *sb, char *buffer, size_t size);
+
+/**
+ * Clear the string and the truncated flag, to build a new string.
+ */
+void str_builder_reset(StrBuilder *sb);
+
+
+/**
+ * Append a null-terminated string.
+ *
+ * All append functions return false if the appended part did not (fully)
+ * fit, or if the builder was already truncated.
+ */
+bool str_builder_append_str(StrBuilder *sb, const char *str);
+
+/**
+ * Append n characters of str (does not have to be null-terminated).
+ */
+bool str_builder_append_strn(StrBuilder *sb, const char *str, size_t n);
+
+bool str_builder_append_char(StrBuilder *sb, char c);
+
+/**
+ * Append a decimal integer, see long_long_to_strn().
+ */
+bool str_builder_append_int(StrBuilder *sb, long long val);
+
+/**
+ * Append a float with num_dec decimals, see f2strn_fixed().
+ */
+bool str_builder_append_float(StrBuilder *sb, float val, unsigned int num_dec);
+
+/**
+ * Append a hexadecimal number of at least 'width' digits (zero padded),
+ * without prefix, see ulong_long_to_hex_strn().
+ */
+bool str_builder_append_hex(StrBuilder *sb, unsigned long long val,
+        unsigned int width, bool uppercase);
+
+
+/**
+ * @return  the (null-terminated) string built so far
+ */
+const char *str_builder_str(const StrBuilder *sb);
+
+/**
+ * @return  length of the string, excluding the terminator
+ */
+size_t str_builder_len(const StrBuilder *sb);
+
+/**
+ * @return  true if an append did not fit: the string is incomplete
+ */
+bool str_builder_is_truncated(const StrBuilder *sb);
+
+
+/*
+ * Struct representing a string builder 'object'.
+ */
+struct str_builder {
+    char *buffer;
+    size_t size;                        // buffer size, including terminator
+    size_t len;                         // current length
+    bool truncated;                     // an append did not fit (sticky)
+};
+
+#endif
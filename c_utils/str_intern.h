@@ -0,0 +1,110 @@
+#ifndef STR_INTERN_H
+#define STR_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// forward declaration, see end of file
+typedef struct str_intern StrIntern;
+
+/*
+ * StrIntern: map strings (e.g. metric or tag names) to small, stable IDs.
+ *
+ * Interning the same string again returns the same ID, so hot paths can
+ * compare and store 32-bit IDs instead of strings. Each distinct string is
+ * copied once into a caller-provided pool. IDs are assigned in order:
+ * 0, 1, 2...
+ *
+ * The table uses open addressing with linear probing and a fast
+ * non-cryptographic hash (8 bytes per step). Optionally, strings are
+ * interned case-insensitively (ASCII): "Host" and "HOST" get the same ID,
+ * the first spelling is stored.
+ *
+ * All memory is provided by the caller, nothing is allocated.
+ */
+
+// returned if a string could not be interned or was not found
+#define STR_INTERN_NONE     (UINT32_MAX)
+
+typedef struct {
+    uint32_t hash;
+    uint32_t id_plus_one;       // 0: empty slot
+} StrInternSlot;
+
+typedef struct {
+    uint32_t offset;            // start of the string in the pool
+    uint32_t len;
+} StrInternEntry;
+
+
+/**
+ * Initialize an empty intern table.
+ *
+ * @param slots         hash table, slot_count elements
+ * @param slot_count    power of two, larger than max_count. About twice
+ *                      max_count keeps the probe sequences short.
+ * @param entries       one entry per string, max_count elements
+ * @param max_count     maximum amount of distinct strings
+ * @param pool          memory for the strings, including a terminator each
+ * @param pool_size     size of the pool in bytes
+ * @param ignore_case   intern case-insensitively (ASCII only)
+ */
+void str_intern_init(StrIntern *table,
+        StrInternSlot *slots, size_t slot_count,
+        StrInternEntry *entries, size_t max_count,
+        char *pool, size_t pool_size, bool ignore_case);
+
+/**
+ * Remove all strings. IDs are assigned from 0 again.
+ */
+void str_intern_clear(StrIntern *table);
+
+/**
+ * Get the ID of a string, add it if it is new.
+ *
+ * @param str   n characters, does not have to be null-terminated
+ *
+ * @return      ID of the string, or STR_INTERN_NONE if it is new and
+ *              there is no room for it (entries or pool full)
+ */
+uint32_t str_intern(StrIntern *table, const char *str, size_t n);
+
+/**
+ * Get the ID of a string without adding it.
+ *
+ * @return      ID of the string, or STR_INTERN_NONE if it is not interned
+ */
+uint32_t str_intern_find(const StrIntern *table, const char *str, size_t n);
+
+/**
+ * Get the (null-terminated) string of an ID.
+ *
+ * @param len   optional (may be NULL): length of the string
+ *
+ * @return      the string, or NULL for an unknown ID
+ */
+const char *str_intern_get(const StrIntern *table, uint32_t id, size_t *len);
+
+/**
+ * @return      amount of strings in the table
+ */
+size_t str_intern_count(const StrIntern *table);
+
+
+/*
+ * Struct representing an intern table 'object'.
+ */
+struct str_intern {
+    StrInternSlot *slots;
+    uint32_t slot_mask;                 // slot_count - 1
+    StrInternEntry *entries;
+    uint32_t max_count;
+    uint32_t count;
+    char *pool;
+    size_t pool_size;
+    size_t pool_used;
+    bool ignore_case;
+};
+
+#endif
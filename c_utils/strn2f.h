@@ -0,0 +1,36 @@
+#ifndef STRN2F_H
+#define STRN2F_H
+
+#include <stddef.h>
+
+/* Parse a float from a string of at most n characters.
+ *
+ * The input does not have to be null-terminated: at most n characters are
+ * read, so it can be used directly on e.g. ringbuffer memory.
+ * Accepted: [+-] digits [. digits] [(e|E) [+-] digits], where either
+ * side of the '.' may be empty, and "inf", "infinity", "nan" (any case).
+ * Unlike strtof(), leading whitespace is not skipped, hexadecimal floats
+ * are not supported and the decimal point is always '.' (no locale).
+ *
+ * The result is correctly rounded (to nearest, ties to even), like strtof().
+ * Out of range values become +-inf or +-0.
+ *
+ * Up to 19 significant digits are converted with integer arithmetic only
+ * (Eisel-Lemire). Longer inputs that are ambiguous at 19 digits use an
+ * exact decimal conversion that needs STRN2F_MAX_DIGITS bytes of stack.
+ *
+ * @param str       input characters
+ * @param n         maximum number of characters to read from str
+ * @param result    parsed value, or 0 if no number was found
+ *
+ * @return          number of characters consumed, or 0 if str does not
+ *                  start with a number
+ */
+size_t strn2f(const char *str, size_t n, float *result);
+
+/* Parse a double from a string of at most n characters.
+ * Same as strn2f(), but rounded to a double like strtod().
+ */
+size_t strn2d(const char *str, size_t n, double *result);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef STRN_TO_INT_H
+#define STRN_TO_INT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Parse a decimal int64_t from a string of at most n characters.
+ *
+ * The input does not have to be null-terminated: at most n characters are
+ * read, so it can be used directly on e.g. ringbuffer memory.
+ * Accepted: [+-] digits. Unlike strtoll(), leading whitespace is not
+ * skipped and there is no base prefix or locale.
+ *
+ * Eight digits at a time are checked and converted with 64-bit integer
+ * operations (SWAR) on little-endian targets.
+ *
+ * @param str       input characters
+ * @param n         maximum number of characters to read from str
+ * @param result    parsed value. 0 if no number was found. If the value
+ *                  does not fit, INT64_MIN or INT64_MAX.
+ *
+ * @return          number of characters consumed, or 0 if str does not
+ *                  start with a number or the value does not fit
+ */
+size_t strn_to_i64(const char *str, size_t n, int64_t *result);
+
+/* Parse a decimal uint64_t from a string of at most n characters.
+ * Same as strn_to_i64(), but only a '+' sign is accepted. If the value
+ * does not fit, the result is UINT64_MAX and 0 is returned.
+ */
+size_t strn_to_u64(const char *str, size_t n, uint64_t *result);
+
+#endif
@@ -0,0 +1,225 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+#include "arena.h"
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+void assert(bool sane)
+{
+    TEST_ASSERT_MESSAGE(sane, "Assertion failed!");
+}
+
+static uint64_t g_memory[64];
+static uint64_t g_memory2[64];
+
+static bool in_memory(const void *ptr, const void *memory, size_t size)
+{
+    const uintptr_t p = (uintptr_t)ptr;
+    return (p >= (uintptr_t)memory) && (p < ((uintptr_t)memory + size));
+}
+
+void test_arena_alloc__aligned_and_in_block(void)
+{
+    Arena arena;
+    arena_init(&arena, g_memory, sizeof(g_memory));
+
+    char *a = arena_alloc(&arena, 1, 1);
+    uint32_t *b = arena_alloc(&arena, sizeof(uint32_t), 4);
+    uint64_t *c = arena_alloc(&arena, sizeof(uint64_t), 16);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL(0, ((uintptr_t)b) % 4);
+    TEST_ASSERT_EQUAL(0, ((uintptr_t)c) % 16);
+    TEST_ASSERT_TRUE((char *)b > a);
+    TEST_ASSERT_TRUE((char *)c >= (char *)(b + 1));
+
+    TEST_ASSERT_TRUE(in_memory(a, g_memory, sizeof(g_memory)));
+    TEST_ASSERT_TRUE(in_memory((char *)(c + 1) - 1, g_memory,
+                sizeof(g_memory)));
+
+    // does not fit
+    TEST_ASSERT_NULL(arena_alloc(&arena, sizeof(g_memory), 1));
+    // zero size allocations work while there is room
+    TEST_ASSERT_NOT_NULL(arena_alloc(&arena, 0, 1));
+}
+
+void test_arena_alloc__fill_block__exact(void)
+{
+    Arena arena;
+    arena_init(&arena, g_memory, sizeof(g_memory));
+
+    size_t total = 0;
+    while(arena_alloc(&arena, 1, 1)) {
+        total++;
+    }
+    TEST_ASSERT_TRUE(total > (sizeof(g_memory) - 64));
+    TEST_ASSERT_TRUE(total < sizeof(g_memory));
+
+    // reset makes all memory available again
+    arena_reset(&arena);
+    char *all = arena_alloc(&arena, total, 1);
+    TEST_ASSERT_NOT_NULL(all);
+    memset(all, 0xAA, total);
+    TEST_ASSERT_NULL(arena_alloc(&arena, 1, 1));
+}
+
+void test_arena_alloc_zero__zeroed(void)
+{
+    Arena arena;
+    memset(g_memory, 0xFF, sizeof(g_memory));
+    arena_init(&arena, g_memory, sizeof(g_memory));
+
+    const uint8_t zero[32] = {0};
+    TEST_ASSERT_EQUAL_MEMORY(zero, arena_alloc_zero(&arena, sizeof(zero), 8),
+            sizeof(zero));
+}
+
+void test_arena_strndup__copies_and_terminates(void)
+{
+    Arena arena;
+    arena_init(&arena, g_memory, sizeof(g_memory));
+
+    const char *input = "key=value;";
+    char *key = arena_strndup(&arena, input, 3);
+    char *value = arena_strndup(&arena, input + 4, 5);
+    TEST_ASSERT_EQUAL_STRING("key", key);
+    TEST_ASSERT_EQUAL_STRING("value", value);
+    TEST_ASSERT_EQUAL_STRING("", arena_strndup(&arena, input, 0));
+}
+
+void test_arena_save_restore__frees_after_marker(void)
+{
+    Arena arena;
+    arena_init(&arena, g_memory, sizeof(g_memory));
+
+    char *keep = arena_alloc(&arena, 8, 8);
+    const ArenaMarker marker = arena_save(&arena);
+    char *temp = arena_alloc(&arena, 16, 8);
+    arena_alloc(&arena, 32, 8);
+
+    arena_restore(&arena, marker);
+    TEST_ASSERT_EQUAL_PTR(temp, arena_alloc(&arena, 16, 8));
+
+    // nested markers
+    const ArenaMarker outer = arena_save(&arena);
+    char *a = arena_alloc(&arena, 4, 4);
+    const ArenaMarker inner = arena_save(&arena);
+    char *b = arena_alloc(&arena, 4, 4);
+    arena_restore(&arena, inner);
+    TEST_ASSERT_EQUAL_PTR(b, arena_alloc(&arena, 4, 4));
+    arena_restore(&arena, outer);
+    TEST_ASSERT_EQUAL_PTR(a, arena_alloc(&arena, 4, 4));
+
+    arena_reset(&arena);
+    TEST_ASSERT_EQUAL_PTR(keep, arena_alloc(&arena, 8, 8));
+}
+
+void test_arena_add_block__chained(void)
+{
+    Arena arena;
+    arena_init(&arena, g_memory, sizeof(g_memory));
+    TEST_ASSERT_TRUE(arena_add_block(&arena, g_memory2, sizeof(g_memory2)));
+    // too small for the block header
+    uint8_t tiny[4];
+    TEST_ASSERT_FALSE(arena_add_block(&arena, tiny, sizeof(tiny)));
+
+    char *first = arena_alloc(&arena, 400, 1);
+    const ArenaMarker marker = arena_save(&arena);
+    char *second = arena_alloc(&arena, 400, 1);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_TRUE(in_memory(first, g_memory, sizeof(g_memory)));
+    TEST_ASSERT_TRUE(in_memory(second, g_memory2, sizeof(g_memory2)));
+
+    // both blocks are full
+    TEST_ASSERT_NULL(arena_alloc(&arena, 400, 1));
+
+    // restore across blocks: continue in the first block
+    arena_restore(&arena, marker);
+    char *small = arena_alloc(&arena, 8, 1);
+    TEST_ASSERT_TRUE(in_memory(small, g_memory, sizeof(g_memory)));
+    TEST_ASSERT_EQUAL_PTR(second, arena_alloc(&arena, 400, 1));
+
+    // reset keeps the second block
+    arena_reset(&arena);
+    TEST_ASSERT_EQUAL_PTR(first, arena_alloc(&arena, 400, 1));
+    TEST_ASSERT_EQUAL_PTR(second, arena_alloc(&arena, 400, 1));
+
+    arena_release(&arena);
+    TEST_ASSERT_NULL(arena_alloc(&arena, 1, 1));
+}
+
+void test_arena_init__empty(void)
+{
+    Arena arena;
+    arena_init(&arena, NULL, 0);
+    TEST_ASSERT_NULL(arena_alloc(&arena, 1, 1));
+
+    const ArenaMarker marker = arena_save(&arena);
+    TEST_ASSERT_TRUE(arena_add_block(&arena, g_memory, sizeof(g_memory)));
+    char *a = arena_alloc(&arena, 8, 8);
+    TEST_ASSERT_NOT_NULL(a);
+    arena_restore(&arena, marker);
+    TEST_ASSERT_EQUAL_PTR(a, arena_alloc(&arena, 8, 8));
+}
+
+#if ARENA_HAS_MMAP
+void test_arena_mmap__grows_and_reuses_chunks(void)
+{
+    Arena arena;
+    arena_init_mmap(&arena, 4096);
+
+    // fill a few chunks
+    char *ptrs[100];
+    for(size_t i=0; i<100; i++) {
+        ptrs[i] = arena_alloc(&arena, 200, 8);
+        TEST_ASSERT_NOT_NULL(ptrs[i]);
+        memset(ptrs[i], (int)i, 200);
+    }
+    for(size_t i=0; i<100; i++) {
+        TEST_ASSERT_EQUAL((char)i, ptrs[i][199]);
+    }
+
+    // larger than a chunk, with large alignment
+    char *big = arena_alloc(&arena, 100000, 4096);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ASSERT_EQUAL(0, ((uintptr_t)big) % 4096);
+    memset(big, 0, 100000);
+
+    // after a reset the same chunks are used again
+    arena_reset(&arena);
+    for(size_t i=0; i<100; i++) {
+        TEST_ASSERT_EQUAL_PTR(ptrs[i], arena_alloc(&arena, 200, 8));
+    }
+
+    arena_release(&arena);
+    TEST_ASSERT_NOT_NULL(arena_alloc(&arena, 10, 1));
+    arena_release(&arena);
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_arena_alloc__aligned_and_in_block);
+    RUN_TEST(test_arena_alloc__fill_block__exact);
+    RUN_TEST(test_arena_alloc_zero__zeroed);
+    RUN_TEST(test_arena_strndup__copies_and_terminates);
+    RUN_TEST(test_arena_save_restore__frees_after_marker);
+    RUN_TEST(test_arena_add_block__chained);
+    RUN_TEST(test_arena_init__empty);
+#if ARENA_HAS_MMAP
+    RUN_TEST(test_arena_mmap__grows_and_reuses_chunks);
+#endif
+
+    UNITY_END();
+
+    return 0;
+}
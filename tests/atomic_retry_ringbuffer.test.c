@@ -0,0 +1,201 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "unity.h"
+#include "atomic_retry_ringbuffer.h"
+
+int g_remaining_asserts = 0;
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+void assert(bool sane)
+{
+    if(g_remaining_asserts) {
+        if(!sane) {
+            g_remaining_asserts--;
+        }
+    } else {
+        TEST_ASSERT_MESSAGE(sane, "Assertion failed!");
+    }
+}
+
+void test_claim_complete_in_order(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[3*1];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 3);
+    AtomicRetryRingbuffer a_rb;
+    atomic_retry_ringbuffer_init(&a_rb, &rb);
+
+    TEST_ASSERT_TRUE(atomic_retry_ringbuffer_is_empty(&a_rb));
+    TEST_ASSERT_NULL(atomic_retry_ringbuffer_claim_read_ptr(&a_rb));
+
+    char *w1 = atomic_retry_ringbuffer_claim_write_ptr(&a_rb);
+    char *w2 = atomic_retry_ringbuffer_claim_write_ptr(&a_rb);
+    *w1 = 'A';
+    atomic_retry_ringbuffer_cancel_write(&a_rb, w2);
+    atomic_retry_ringbuffer_complete_write(&a_rb, w1);
+    TEST_ASSERT_FALSE(atomic_retry_ringbuffer_is_empty(&a_rb));
+
+    char *r = atomic_retry_ringbuffer_claim_read_ptr(&a_rb);
+    TEST_ASSERT_EQUAL_CHAR('A', *r);
+    TEST_ASSERT_NULL(atomic_retry_ringbuffer_claim_read_ptr(&a_rb));
+
+    atomic_retry_ringbuffer_cancel_read(&a_rb, r);
+    r = atomic_retry_ringbuffer_claim_read_ptr(&a_rb);
+    TEST_ASSERT_EQUAL_CHAR('A', *r);
+    atomic_retry_ringbuffer_complete_read(&a_rb, r);
+    TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+
+    // expect assertion failure: cannot complete more than claimed
+    g_remaining_asserts = 1;
+    atomic_retry_ringbuffer_complete_read(&a_rb, NULL);
+    TEST_ASSERT_EQUAL(0, g_remaining_asserts);
+}
+
+void test_wrapping_write__discards_unclaimed_oldest(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[2*1];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 2);
+    AtomicRetryRingbuffer a_rb;
+    atomic_retry_ringbuffer_init(&a_rb, &rb);
+
+    const char *data = "ABC";
+    for(size_t i=0; i<3; i++) {
+        char *w = atomic_retry_ringbuffer_wrapping_write_ptr(&a_rb);
+        TEST_ASSERT_NOT_NULL(w);
+        *w = data[i];
+        atomic_retry_ringbuffer_complete_write(&a_rb, w);
+    }
+
+    char *r = atomic_retry_ringbuffer_claim_read_ptr(&a_rb);
+    TEST_ASSERT_EQUAL_CHAR('B', *r);
+
+    // oldest element is claimed: it is not overwritten
+    TEST_ASSERT_NULL(atomic_retry_ringbuffer_wrapping_write_ptr(&a_rb));
+    TEST_ASSERT_TRUE(ringbuffer_is_overflowed(&rb));
+    TEST_ASSERT_EQUAL_CHAR('B', *r);
+
+    // after canceling, it can be discarded
+    atomic_retry_ringbuffer_cancel_all_reads(&a_rb);
+    char *w = atomic_retry_ringbuffer_wrapping_write_ptr(&a_rb);
+    TEST_ASSERT_NOT_NULL(w);
+    *w = 'D';
+    atomic_retry_ringbuffer_complete_write(&a_rb, w);
+
+    r = atomic_retry_ringbuffer_claim_read_ptr(&a_rb);
+    TEST_ASSERT_EQUAL_CHAR('C', *r);
+    r = atomic_retry_ringbuffer_claim_read_ptr(&a_rb);
+    TEST_ASSERT_EQUAL_CHAR('D', *r);
+    atomic_retry_ringbuffer_complete_all_reads(&a_rb);
+    TEST_ASSERT_TRUE(atomic_retry_ringbuffer_is_empty(&a_rb));
+    TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+}
+
+
+// Concurrent test: the producer writes a running counter (and its inverse,
+// to detect torn elements) with wrapping_write_ptr(). The consumer should
+// see strictly increasing, intact elements.
+
+#define STRESS_COUNT (200000)
+
+typedef struct {
+    uint32_t seq;
+    uint32_t inv;
+} StressElement;
+
+static bool g_producer_done;
+
+static void *stress_producer(void *arg)
+{
+    AtomicRetryRingbuffer *ctx = arg;
+
+    for(uint32_t seq=1; seq<=STRESS_COUNT; seq++) {
+        StressElement *e;
+        while(!(e = atomic_retry_ringbuffer_wrapping_write_ptr(ctx))) {
+            sched_yield();
+        }
+        e->seq = seq;
+        e->inv = ~seq;
+        atomic_retry_ringbuffer_complete_write(ctx, e);
+    }
+    __atomic_store_n(&g_producer_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+void test_concurrent_producer_consumer(void)
+{
+    g_remaining_asserts = 0;
+
+    StressElement buffer[8];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, sizeof(StressElement), 8);
+    AtomicRetryRingbuffer a_rb;
+    atomic_retry_ringbuffer_init(&a_rb, &rb);
+
+    __atomic_store_n(&g_producer_done, false, __ATOMIC_RELEASE);
+    pthread_t producer;
+    TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL,
+                stress_producer, &a_rb));
+
+    uint32_t last_seq = 0;
+    uint32_t received = 0;
+    uint32_t round = 0;
+    for(;;) {
+        const bool producer_done = __atomic_load_n(&g_producer_done,
+                __ATOMIC_ACQUIRE);
+
+        uint32_t claimed_seq[4];
+        uint32_t claimed = 0;
+        StressElement *e;
+        while((claimed < 4) && (e = atomic_retry_ringbuffer_claim_read_ptr(&a_rb))) {
+            TEST_ASSERT_EQUAL_UINT32(~e->seq, e->inv);
+            claimed_seq[claimed++] = e->seq;
+        }
+
+        // every third round, pretend the transfer failed
+        if((++round % 3) == 0) {
+            atomic_retry_ringbuffer_cancel_all_reads(&a_rb);
+            continue;
+        }
+        for(uint32_t i=0; i<claimed; i++) {
+            TEST_ASSERT_TRUE(claimed_seq[i] > last_seq);
+            last_seq = claimed_seq[i];
+            received++;
+        }
+        atomic_retry_ringbuffer_complete_all_reads(&a_rb);
+
+        if(producer_done && atomic_retry_ringbuffer_is_empty(&a_rb)) {
+            break;
+        }
+    }
+    pthread_join(producer, NULL);
+
+    // the last element can never be discarded
+    TEST_ASSERT_EQUAL_UINT32(STRESS_COUNT, last_seq);
+    TEST_ASSERT_TRUE(received > 0);
+    TEST_ASSERT_TRUE(atomic_retry_ringbuffer_is_empty(&a_rb));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_claim_complete_in_order);
+    RUN_TEST(test_wrapping_write__discards_unclaimed_oldest);
+    RUN_TEST(test_concurrent_producer_consumer);
+
+    UNITY_END();
+
+    return 0;
+}
@@ -12,6 +12,7 @@ void tearDown(void){}
 
 // Set to 1 to run all possible floats trough the test.
 // Note: depending on your hardware this test may take several hours!
+// See f2strn_exhaustive.test.c for a multi-threaded run over all floats.
 #define RUN_BRUTEFORCE_TEST (0)
 
 void TEST_ASSERT_FLOATS_EXACTLY_THE_SAME(float reference, float testvalue)
@@ -102,6 +103,282 @@ void test_f2strn__not_a_number__returns_nan(void)
     TEST_ASSERT_EQUAL_STRING(buf,f2strn(a, string, 256, 1));
 }
 
+void test_f2strn__exact_digits_and_rounding(void)
+{
+    char string[256];
+    char buf[256];
+
+    // large values: all digits are exact
+    const float values[] = {3.4028235e38f, 223452345.0f, 16777217.0f,
+        0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 0.375f, 9.9996f, -0.001f, 0.0f,
+        1.4e-45f};
+    for(size_t i=0; i<sizeof(values)/sizeof(values[0]); i++) {
+        for(int num_dec=0; num_dec<8; num_dec++) {
+            snprintf(buf, sizeof(buf), "%.*f", num_dec, values[i]);
+            TEST_ASSERT_EQUAL_STRING(buf,
+                    f2strn(values[i], string, sizeof(string), num_dec));
+        }
+    }
+
+    // round half to even
+    TEST_ASSERT_EQUAL_STRING("2", f2strn(2.5f, string, 256, 0));
+    TEST_ASSERT_EQUAL_STRING("0.12", f2strn(0.125f, string, 256, 2));
+    TEST_ASSERT_EQUAL_STRING("10.000", f2strn(9.9996f, string, 256, 3));
+    TEST_ASSERT_EQUAL_STRING("-0.00", f2strn(-0.001f, string, 256, 2));
+
+    // buffer too small: truncated to n-1 characters
+    char small[6];
+    TEST_ASSERT_EQUAL_STRING("12345", f2strn(123456.5f, small, 6, 2));
+    TEST_ASSERT_EQUAL_STRING("100.0", f2strn(99.996f, small, 6, 2));
+}
+
+static void assert_shortest(const char *expected, float a)
+{
+    char string[F2STRN_SHORTEST_SIZE];
+    TEST_ASSERT_EQUAL(strlen(expected),
+            f2strn_shortest(a, string, sizeof(string)));
+    TEST_ASSERT_EQUAL_STRING(expected, string);
+}
+
+void test_f2strn_shortest__round_trips(void)
+{
+    char string[F2STRN_SHORTEST_SIZE];
+
+    assert_shortest("0.1", 0.1f);
+    assert_shortest("-2.5", -2.5f);
+    assert_shortest("0", 0.0f);
+    assert_shortest("-0", -0.0f);
+    assert_shortest("123456.7", 123456.7f);
+    assert_shortest("16777216", 16777216.0f);
+    assert_shortest("100000000000000000000", 1e20f);
+    assert_shortest("1e+21", 1e21f);
+    assert_shortest("0.000001", 1e-6f);
+    assert_shortest("1e-7", 1e-7f);
+    assert_shortest("3.4028235e+38", 3.4028235e38f);
+    assert_shortest("1e-45", 1.4e-45f);
+    assert_shortest("-inf", -INFINITY);
+    assert_shortest("nan", NAN);
+
+    // every float reads back the same
+    union float_bytes {
+        float val;
+        uint32_t bits;
+    } data;
+    for(uint32_t i=0; i<100000; i++) {
+        data.bits = i * 42953u;
+        if(isnan(data.val)) {
+            continue;
+        }
+        f2strn_shortest(data.val, string, sizeof(string));
+        TEST_ASSERT_FLOATS_EXACTLY_THE_SAME(data.val, strtof(string, NULL));
+    }
+}
+
+void test_f2strn_fixed__returns_length(void)
+{
+    char string[256];
+    char buf[256];
+
+    // fast path (num_dec <= 9, small values) and general path
+    const float values[] = {0.0f, -0.0f, 1.005f, -1234.5678f, 0.125f,
+        0.000123f, 17179869184.0f, 17179870000.0f, 3.4028235e38f, 1e-30f};
+    for(size_t i=0; i<sizeof(values)/sizeof(values[0]); i++) {
+        for(unsigned int num_dec=0; num_dec<12; num_dec++) {
+            const int len = snprintf(buf, sizeof(buf), "%.*f", num_dec,
+                    values[i]);
+            TEST_ASSERT_EQUAL(len, f2strn_fixed(values[i], string,
+                        sizeof(string), num_dec));
+            TEST_ASSERT_EQUAL_STRING(buf, string);
+        }
+    }
+
+    // buffer too small: truncated, but the full length is returned
+    char small[5];
+    TEST_ASSERT_EQUAL(8, f2strn_fixed(-123.456f, small, sizeof(small), 3));
+    TEST_ASSERT_EQUAL_STRING("-123", small);
+    TEST_ASSERT_EQUAL(4, f2strn_fixed(1.0f, small, 0, 2));
+    TEST_ASSERT_EQUAL_STRING("-123", small);
+}
+
+void test_f2strn__small_buffer__never_overflows(void)
+{
+    const float values[] = {-INFINITY, NAN, -123.456f, 3.4028235e38f};
+
+    for(size_t i=0; i<sizeof(values)/sizeof(values[0]); i++) {
+        for(size_t n=0; n<8; n++) {
+            char string[16];
+            memset(string, 'X', sizeof(string));
+            f2strn(values[i], string, n, 20);
+            TEST_ASSERT_EQUAL_CHAR('X', string[n]);
+            if(n) {
+                TEST_ASSERT_TRUE(strnlen(string, n) < n);
+            }
+
+            memset(string, 'X', sizeof(string));
+            f2strn_shortest(values[i], string, n);
+            TEST_ASSERT_EQUAL_CHAR('X', string[n]);
+
+            memset(string, 'X', sizeof(string));
+            f2strn_exp(values[i], string, n, 20);
+            TEST_ASSERT_EQUAL_CHAR('X', string[n]);
+
+            memset(string, 'X', sizeof(string));
+            d2strn_general(values[i], string, n, 20);
+            TEST_ASSERT_EQUAL_CHAR('X', string[n]);
+        }
+    }
+
+    char string[4];
+    TEST_ASSERT_EQUAL(4, f2strn_fixed(-INFINITY, string, sizeof(string), 2));
+    TEST_ASSERT_EQUAL_STRING("-in", string);
+}
+
+void test_f2strn_exp_and_general__match_printf(void)
+{
+    char string[256];
+    char buf[256];
+
+    const float values[] = {0.0f, -0.0f, 1.0f, 9.9996f, -123.456f, 0.0001f,
+        0.00001234f, 123456.0f, 3.4028235e38f, 1.4e-45f, 2.5f, 999999.5f};
+    for(size_t i=0; i<sizeof(values)/sizeof(values[0]); i++) {
+        for(unsigned int precision=0; precision<12; precision++) {
+            int len = snprintf(buf, sizeof(buf), "%.*e", precision,
+                    values[i]);
+            TEST_ASSERT_EQUAL(len, f2strn_exp(values[i], string,
+                        sizeof(string), precision));
+            TEST_ASSERT_EQUAL_STRING(buf, string);
+
+            len = snprintf(buf, sizeof(buf), "%.*g", precision, values[i]);
+            TEST_ASSERT_EQUAL(len, f2strn_general(values[i], string,
+                        sizeof(string), precision));
+            TEST_ASSERT_EQUAL_STRING(buf, string);
+        }
+    }
+
+    // rounding carries into the exponent
+    f2strn_exp(9.9996f, string, sizeof(string), 2);
+    TEST_ASSERT_EQUAL_STRING("1.00e+01", string);
+    f2strn_general(0.0001f, string, sizeof(string), 3);
+    TEST_ASSERT_EQUAL_STRING("0.0001", string);
+    f2strn_general(123456.0f, string, sizeof(string), 3);
+    TEST_ASSERT_EQUAL_STRING("1.23e+05", string);
+}
+
+void test_d2strn__matches_printf(void)
+{
+    char string[1200];
+    char buf[1200];
+
+    const double values[] = {0.0, -0.0, 0.1, 1.0 / 3.0, -2.5, 0.125,
+        9.9999995, 123456789.987654321, 9007199254740993.0, 1e21, 1e-7,
+        1.7976931348623157e308, 2.2250738585072014e-308, 4.9e-324};
+    for(size_t i=0; i<sizeof(values)/sizeof(values[0]); i++) {
+        for(unsigned int precision=0; precision<20; precision+= 3) {
+            int len = snprintf(buf, sizeof(buf), "%.*f", precision,
+                    values[i]);
+            TEST_ASSERT_EQUAL(len, d2strn(values[i], string, sizeof(string),
+                        precision));
+            TEST_ASSERT_EQUAL_STRING(buf, string);
+
+            len = snprintf(buf, sizeof(buf), "%.*e", precision, values[i]);
+            TEST_ASSERT_EQUAL(len, d2strn_exp(values[i], string,
+                        sizeof(string), precision));
+            TEST_ASSERT_EQUAL_STRING(buf, string);
+
+            len = snprintf(buf, sizeof(buf), "%.*g", precision, values[i]);
+            TEST_ASSERT_EQUAL(len, d2strn_general(values[i], string,
+                        sizeof(string), precision));
+            TEST_ASSERT_EQUAL_STRING(buf, string);
+        }
+    }
+
+    // all 1074 decimals of the smallest double are exact
+    snprintf(buf, sizeof(buf), "%.1074f", 4.9e-324);
+    TEST_ASSERT_EQUAL(1076, d2strn(4.9e-324, string, sizeof(string), 1074));
+    TEST_ASSERT_EQUAL_STRING(buf, string);
+
+    TEST_ASSERT_EQUAL(3, d2strn(INFINITY, string, sizeof(string), 2));
+    TEST_ASSERT_EQUAL_STRING("inf", string);
+    d2strn_exp(-NAN, string, sizeof(string), 2);
+    TEST_ASSERT_EQUAL_STRING("-nan", string);
+}
+
+void test_d2strn_shortest__round_trips(void)
+{
+    char string[D2STRN_SHORTEST_SIZE];
+
+    d2strn_shortest(0.1, string, sizeof(string));
+    TEST_ASSERT_EQUAL_STRING("0.1", string);
+    d2strn_shortest(1.0 / 3.0, string, sizeof(string));
+    TEST_ASSERT_EQUAL_STRING("0.3333333333333333", string);
+    d2strn_shortest(-1.7976931348623157e308, string, sizeof(string));
+    TEST_ASSERT_EQUAL_STRING("-1.7976931348623157e+308", string);
+    d2strn_shortest(4.9e-324, string, sizeof(string));
+    TEST_ASSERT_EQUAL_STRING("5e-324", string);
+    TEST_ASSERT_EQUAL(16, d2strn_shortest(9007199254740992.0, string,
+                sizeof(string)));
+    TEST_ASSERT_EQUAL_STRING("9007199254740992", string);
+
+    // every double reads back the same
+    union double_bytes {
+        double val;
+        uint64_t bits;
+    } data;
+    for(uint64_t i=0; i<100000; i++) {
+        data.bits = i * 0x9e3779b97f4a7c15ULL;
+        if(isnan(data.val)) {
+            continue;
+        }
+        d2strn_shortest(data.val, string, sizeof(string));
+        TEST_ASSERT_TRUE(data.val == strtod(string, NULL));
+    }
+}
+
+void test_f2strn_array__writes_whole_values(void)
+{
+    const float values[] = {1.5f, -0.25f, 1e30f, NAN, 3.14159f, 0.0f};
+    const size_t count = sizeof(values)/sizeof(values[0]);
+    char string[256];
+    char buf[256];
+
+    // same as f2strn_fixed() per value, joined by the separator
+    size_t len = 0;
+    buf[0] = '\0';
+    for(size_t i=0; i<count; i++) {
+        size_t used = strlen(buf);
+        snprintf(buf + used, sizeof(buf) - used, "%s%.2f", i ? ", " : "",
+                values[i]);
+    }
+    TEST_ASSERT_EQUAL(count, f2strn_array(values, count, string,
+                sizeof(string), 2, ", ", &len));
+    TEST_ASSERT_EQUAL_STRING(buf, string);
+    TEST_ASSERT_EQUAL(strlen(buf), len);
+
+    // "1.50, -0.25, 1000000015047466219876688855040.00": the third value
+    // does not fit, neither does its separator
+    char small[20];
+    TEST_ASSERT_EQUAL(2, f2strn_array(values, count, small, sizeof(small), 2,
+                ", ", &len));
+    TEST_ASSERT_EQUAL_STRING("1.50, -0.25", small);
+    TEST_ASSERT_EQUAL(11, len);
+
+    // continue where it stopped
+    TEST_ASSERT_EQUAL(0, f2strn_array(values + 2, count - 2, small,
+                sizeof(small), 2, ", ", &len));
+    TEST_ASSERT_EQUAL_STRING("", small);
+    TEST_ASSERT_EQUAL(3, f2strn_array(values + 3, count - 3, small,
+                sizeof(small), 2, ", ", &len));
+    TEST_ASSERT_EQUAL_STRING("nan, 3.14, 0.00", small);
+
+    // no separator, empty buffer
+    TEST_ASSERT_EQUAL(2, f2strn_array(values, 2, string, sizeof(string), 0,
+                NULL, NULL));
+    TEST_ASSERT_EQUAL_STRING("2-0", string);
+    TEST_ASSERT_EQUAL(0, f2strn_array(values, count, string, 0, 2, ",",
+                &len));
+    TEST_ASSERT_EQUAL(0, len);
+}
+
 void print_bruteforce_float(char *prefix, float n)
 {
     printf("%s", prefix);
@@ -165,6 +442,14 @@ int main(void)
     RUN_TEST(test_f2strn__hardcoded_floats__match);
     RUN_TEST(test_f2strn__infinity__returns_inf);
     RUN_TEST(test_f2strn__not_a_number__returns_nan);
+    RUN_TEST(test_f2strn__exact_digits_and_rounding);
+    RUN_TEST(test_f2strn_shortest__round_trips);
+    RUN_TEST(test_f2strn_fixed__returns_length);
+    RUN_TEST(test_f2strn__small_buffer__never_overflows);
+    RUN_TEST(test_f2strn_exp_and_general__match_printf);
+    RUN_TEST(test_d2strn__matches_printf);
+    RUN_TEST(test_d2strn_shortest__round_trips);
+    RUN_TEST(test_f2strn_array__writes_whole_values);
 #if RUN_BRUTEFORCE_TEST
     RUN_TEST(test_f2strn__bruteforce__match);
 #endif
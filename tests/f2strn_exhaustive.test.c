@@ -0,0 +1,310 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "f2strn.h"
+
+/* Exhaustive check of the float formatters against printf(): every float
+ * bit pattern is formatted on all cores and compared with the reference.
+ * Mismatches are counted (the first few are printed), and the time per
+ * value is printed for both f2strn and the reference.
+ *
+ * By default only every EXHAUSTIVE_STRIDE'th bit pattern is tested, so the
+ * test stays quick. For the full 2^32 run, build with
+ * -DEXHAUSTIVE_STRIDE=1 and optimizations enabled: this takes a few
+ * minutes per num_dec on a many-core machine.
+ */
+
+#ifndef EXHAUSTIVE_STRIDE
+#define EXHAUSTIVE_STRIDE       (4099)      // test every n'th bit pattern
+#endif
+#ifndef EXHAUSTIVE_THREADS
+#define EXHAUSTIVE_THREADS      (0)         // 0: one thread per online core
+#endif
+#ifndef EXHAUSTIVE_NUM_DEC
+#define EXHAUSTIVE_NUM_DEC      {0, 1, 2, 3, 6, 9}
+#endif
+#ifndef EXHAUSTIVE_MAX_REPORT
+#define EXHAUSTIVE_MAX_REPORT   (10)        // mismatches printed per run
+#endif
+
+#define BIT_PATTERNS            (1ULL << 32)
+#define BATCH_SIZE              (64)        // values timed per clock read
+#define BATCH_COUNT             (256)       // batches claimed per work item
+#define RESULT_SIZE             (64)        // fits any float with 9 decimals
+#define MAX_THREADS             (256)
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+
+typedef size_t (*FormatFunc)(float a, char *str, size_t n,
+        unsigned int param);
+
+// check 'result' (of length 'len') against the reference output
+typedef bool (*CheckFunc)(float a, const char *result, size_t len,
+        const char *reference, size_t ref_len);
+
+typedef struct {
+    const char *name;
+    FormatFunc format;
+    FormatFunc reference;
+    CheckFunc check;
+    unsigned int param;
+} Mode;
+
+typedef struct {
+    const Mode *mode;
+    uint64_t next_index;        // next work item, shared by all threads
+    uint64_t index_count;       // amount of bit patterns to test
+    uint64_t mismatches;
+    uint64_t reported;
+    pthread_mutex_t report_lock;
+} Run;
+
+typedef struct {
+    Run *run;
+    uint64_t values;
+    uint64_t format_ns;
+    uint64_t reference_ns;
+} Worker;
+
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static float float_from_bits(uint32_t bits)
+{
+    float a;
+    memcpy(&a, &bits, sizeof(a));
+    return a;
+}
+
+static size_t printf_fixed(float a, char *str, size_t n, unsigned int param)
+{
+    return (size_t)snprintf(str, n, "%.*f", (int)param, a);
+}
+
+static size_t printf_shortest(float a, char *str, size_t n,
+        unsigned int param)
+{
+    // nine significant digits always round-trip
+    return (size_t)snprintf(str, n, "%.9g", a);
+}
+
+static size_t f2strn_shortest_mode(float a, char *str, size_t n,
+        unsigned int param)
+{
+    return f2strn_shortest(a, str, n);
+}
+
+static bool check_same_string(float a, const char *result, size_t len,
+        const char *reference, size_t ref_len)
+{
+    return (len == ref_len) && !strcmp(result, reference);
+}
+
+static bool check_round_trip(float a, const char *result, size_t len,
+        const char *reference, size_t ref_len)
+{
+    if(len != strlen(result)) {
+        return false;
+    }
+    char *end;
+    const float parsed = strtof(result, &end);
+    if(end != (result + len)) {
+        return false;
+    }
+    if(isnan(a)) {
+        return isnan(parsed);
+    }
+    return !memcmp(&a, &parsed, sizeof(a));
+}
+
+static void report_mismatch(Run *run, float a, uint32_t bits,
+        const char *result, const char *reference)
+{
+    pthread_mutex_lock(&run->report_lock);
+    run->mismatches++;
+    if(run->reported < EXHAUSTIVE_MAX_REPORT) {
+        run->reported++;
+        printf("%s: 0x%08x (%.9g): got '%s', expected '%s'\n",
+                run->mode->name, (unsigned int)bits, a, result, reference);
+    }
+    pthread_mutex_unlock(&run->report_lock);
+}
+
+static void run_batch(Worker *worker, uint64_t first, uint64_t count)
+{
+    const Mode *mode = worker->run->mode;
+    char results[BATCH_SIZE][RESULT_SIZE];
+    char references[BATCH_SIZE][RESULT_SIZE];
+    size_t lengths[BATCH_SIZE];
+    size_t ref_lengths[BATCH_SIZE];
+
+    // time both formatters on the same batch, compare afterwards
+    const uint64_t t0 = now_ns();
+    for(uint64_t i=0; i<count; i++) {
+        const uint32_t bits = (uint32_t)((first + i) * EXHAUSTIVE_STRIDE);
+        lengths[i] = mode->format(float_from_bits(bits),
+                results[i], RESULT_SIZE, mode->param);
+    }
+    const uint64_t t1 = now_ns();
+    for(uint64_t i=0; i<count; i++) {
+        const uint32_t bits = (uint32_t)((first + i) * EXHAUSTIVE_STRIDE);
+        ref_lengths[i] = mode->reference(float_from_bits(bits),
+                references[i], RESULT_SIZE, mode->param);
+    }
+    const uint64_t t2 = now_ns();
+
+    worker->format_ns+= t1 - t0;
+    worker->reference_ns+= t2 - t1;
+    worker->values+= count;
+
+    for(uint64_t i=0; i<count; i++) {
+        const uint32_t bits = (uint32_t)((first + i) * EXHAUSTIVE_STRIDE);
+        const float a = float_from_bits(bits);
+        if(!mode->check(a, results[i], lengths[i],
+                    references[i], ref_lengths[i])) {
+            report_mismatch(worker->run, a, bits, results[i], references[i]);
+        }
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    Worker *worker = arg;
+    Run *run = worker->run;
+    const uint64_t item_size = BATCH_SIZE * BATCH_COUNT;
+
+    for(;;) {
+        const uint64_t first = __atomic_fetch_add(&run->next_index,
+                item_size, __ATOMIC_RELAXED);
+        if(first >= run->index_count) {
+            break;
+        }
+        uint64_t end = first + item_size;
+        if(end > run->index_count) {
+            end = run->index_count;
+        }
+        for(uint64_t i=first; i<end; i+= BATCH_SIZE) {
+            const uint64_t left = end - i;
+            run_batch(worker, i, (left < BATCH_SIZE) ? left : BATCH_SIZE);
+        }
+    }
+    return NULL;
+}
+
+static unsigned int thread_count(void)
+{
+    long count = EXHAUSTIVE_THREADS;
+    if(count <= 0) {
+        count = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if(count < 1) {
+        count = 1;
+    }
+    if(count > MAX_THREADS) {
+        count = MAX_THREADS;
+    }
+    return (unsigned int)count;
+}
+
+// run all bit patterns through 'mode', return the amount of mismatches
+static uint64_t run_mode(const Mode *mode)
+{
+    Run run = {
+        .mode = mode,
+        .next_index = 0,
+        .index_count = (BIT_PATTERNS + EXHAUSTIVE_STRIDE - 1)
+            / EXHAUSTIVE_STRIDE,
+    };
+    pthread_mutex_init(&run.report_lock, NULL);
+
+    const unsigned int threads = thread_count();
+    pthread_t thread[MAX_THREADS];
+    Worker workers[MAX_THREADS];
+
+    const uint64_t start = now_ns();
+    for(unsigned int t=0; t<threads; t++) {
+        workers[t] = (Worker){.run = &run};
+        TEST_ASSERT_EQUAL(0, pthread_create(&thread[t], NULL,
+                    worker_main, &workers[t]));
+    }
+    uint64_t values = 0;
+    uint64_t format_ns = 0;
+    uint64_t reference_ns = 0;
+    for(unsigned int t=0; t<threads; t++) {
+        pthread_join(thread[t], NULL);
+        values+= workers[t].values;
+        format_ns+= workers[t].format_ns;
+        reference_ns+= workers[t].reference_ns;
+    }
+    const double seconds = (double)(now_ns() - start) / 1e9;
+    pthread_mutex_destroy(&run.report_lock);
+
+    TEST_ASSERT_EQUAL_UINT64(run.index_count, values);
+    printf("%s: %llu values, %llu mismatches, %.1f ns/value "
+            "(reference %.1f ns/value), %u threads, %.1f s\n",
+            mode->name, (unsigned long long)values,
+            (unsigned long long)run.mismatches,
+            (double)format_ns / values, (double)reference_ns / values,
+            threads, seconds);
+    return run.mismatches;
+}
+
+
+void test_f2strn_fixed__all_floats__match_printf(void)
+{
+    const unsigned int num_decs[] = EXHAUSTIVE_NUM_DEC;
+    uint64_t mismatches = 0;
+
+    for(size_t i=0; i<(sizeof(num_decs)/sizeof(num_decs[0])); i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "f2strn_fixed %u", num_decs[i]);
+        const Mode mode = {
+            .name = name,
+            .format = f2strn_fixed,
+            .reference = printf_fixed,
+            .check = check_same_string,
+            .param = num_decs[i],
+        };
+        mismatches+= run_mode(&mode);
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, mismatches);
+}
+
+void test_f2strn_shortest__all_floats__round_trip(void)
+{
+    const Mode mode = {
+        .name = "f2strn_shortest",
+        .format = f2strn_shortest_mode,
+        .reference = printf_shortest,
+        .check = check_round_trip,
+    };
+    TEST_ASSERT_EQUAL_UINT64(0, run_mode(&mode));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_f2strn_fixed__all_floats__match_printf);
+    RUN_TEST(test_f2strn_shortest__all_floats__round_trip);
+
+    UNITY_END();
+
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 #include "long_long_to_str.h"
 #include "unity.h"
 #include <stdlib.h>
@@ -9,6 +10,32 @@
 void setUp(void){}
 void tearDown(void){}
 
+int g_remaining_asserts = 0;
+
+void assert(bool sane)
+{
+    if(g_remaining_asserts) {
+        if(!sane) {
+            g_remaining_asserts--;
+        }
+    } else {
+        TEST_ASSERT_MESSAGE(sane, "Assertion failed!");
+    }
+}
+
+static unsigned long long g_rand_state = 0x9E3779B97F4A7C15ULL;
+
+// xorshift64, shifted so every magnitude is covered
+static unsigned long long rand_value(int i)
+{
+    unsigned long long x = g_rand_state;
+    x^= x << 13;
+    x^= x >> 7;
+    x^= x << 17;
+    g_rand_state = x;
+    return x >> (i % 64);
+}
+
 void test__hardcoded__match(void)
 {
     char string[256];
@@ -82,12 +109,220 @@ void test__hardcoded__match(void)
     TEST_ASSERT_EQUAL_STRING("-9223372036854775808",  string);
 }
 
+void test_long_long_to_strn__matches_snprintf(void)
+{
+    char string[32];
+    char expected[32];
+
+    // every digit count, around each power of ten, both signs
+    long long p = 1;
+    for(int digits=1; digits<=19; digits++) {
+        const long long values[] = {p - 1, p, p + 1, 3 * p, -p, -(p + 1)};
+        for(size_t i=0; i<(sizeof(values)/sizeof(values[0])); i++) {
+            const int len = snprintf(expected, sizeof(expected),
+                    "%lld", values[i]);
+            TEST_ASSERT_EQUAL(len, long_long_to_strn(string, sizeof(string),
+                        values[i]));
+            TEST_ASSERT_EQUAL_STRING(expected, string);
+        }
+        if(digits < 19) {
+            p*= 10;
+        }
+    }
+
+    // pseudo-random values of every magnitude
+    for(int i=0; i<100000; i++) {
+        const long long val = (long long)rand_value(i);
+        const int len = snprintf(expected, sizeof(expected), "%lld", val);
+        TEST_ASSERT_EQUAL(len, long_long_to_strn(string, sizeof(string), val));
+        TEST_ASSERT_EQUAL_STRING(expected, string);
+    }
+}
+
+void test_long_long_to_strn__small_buffer__truncates(void)
+{
+    char string[8];
+
+    memset(string, 0x33, sizeof(string));
+    TEST_ASSERT_EQUAL(6, long_long_to_strn(string, 4, -12345));
+    TEST_ASSERT_EQUAL_STRING("-12", string);
+    TEST_ASSERT_EQUAL(0x33, string[4]);
+
+    // exactly fits, or one too short
+    TEST_ASSERT_EQUAL(7, long_long_to_strn(string, 8, 1234567));
+    TEST_ASSERT_EQUAL_STRING("1234567", string);
+    TEST_ASSERT_EQUAL(8, long_long_to_strn(string, 8, 12345678));
+    TEST_ASSERT_EQUAL_STRING("1234567", string);
+    TEST_ASSERT_FALSE(long_long_to_str(string, 8, 12345678));
+    TEST_ASSERT_TRUE(long_long_to_str(string, 8, -123456));
+
+    // nothing is written to an empty buffer
+    memset(string, 0x33, sizeof(string));
+    TEST_ASSERT_EQUAL(1, long_long_to_strn(string, 0, 5));
+    TEST_ASSERT_EQUAL(0x33, string[0]);
+    TEST_ASSERT_EQUAL(2, long_long_to_strn(string, 1, -5));
+    TEST_ASSERT_EQUAL_STRING("", string);
+}
+
+void test_ulong_long_to_strn__formats_match_snprintf(void)
+{
+    char string[80];
+    char expected[80];
+
+    for(int i=0; i<100000; i++) {
+        const unsigned long long val = (i < 2) ? (i ? ULLONG_MAX : 0)
+            : rand_value(i);
+        const unsigned int width = i % 24;
+        int len;
+
+        len = snprintf(expected, sizeof(expected), "%llu", val);
+        TEST_ASSERT_EQUAL(len, ulong_long_to_strn(string, sizeof(string), val));
+        TEST_ASSERT_EQUAL_STRING(expected, string);
+
+        len = snprintf(expected, sizeof(expected), "%0*llu", width, val);
+        TEST_ASSERT_EQUAL(len, ulong_long_to_strn_padded(string,
+                    sizeof(string), val, width));
+        TEST_ASSERT_EQUAL_STRING(expected, string);
+
+        len = snprintf(expected, sizeof(expected), "%0*llx", width, val);
+        TEST_ASSERT_EQUAL(len, ulong_long_to_hex_strn(string,
+                    sizeof(string), val, width, false));
+        TEST_ASSERT_EQUAL_STRING(expected, string);
+
+        len = snprintf(expected, sizeof(expected), "%0*llX", width, val);
+        TEST_ASSERT_EQUAL(len, ulong_long_to_hex_strn(string,
+                    sizeof(string), val, width, true));
+        TEST_ASSERT_EQUAL_STRING(expected, string);
+
+        len = snprintf(expected, sizeof(expected), "%0*llo", width, val);
+        TEST_ASSERT_EQUAL(len, ulong_long_to_base_strn(string,
+                    sizeof(string), val, 8, width));
+        TEST_ASSERT_EQUAL_STRING(expected, string);
+
+        len = snprintf(expected, sizeof(expected), "%0*llu", width, val);
+        TEST_ASSERT_EQUAL(len, ulong_long_to_base_strn(string,
+                    sizeof(string), val, 10, width));
+        TEST_ASSERT_EQUAL_STRING(expected, string);
+    }
+}
+
+void test_ulong_long_to_base_strn__hardcoded__match(void)
+{
+    char string[80];
+
+    TEST_ASSERT_EQUAL(4, ulong_long_to_base_strn(string, sizeof(string),
+                10, 2, 0));
+    TEST_ASSERT_EQUAL_STRING("1010", string);
+    TEST_ASSERT_EQUAL(8, ulong_long_to_base_strn(string, sizeof(string),
+                10, 2, 8));
+    TEST_ASSERT_EQUAL_STRING("00001010", string);
+    TEST_ASSERT_EQUAL(64, ulong_long_to_base_strn(string, sizeof(string),
+                ULLONG_MAX, 2, 0));
+    TEST_ASSERT_EQUAL_STRING(
+            "1111111111111111111111111111111111111111111111111111111111111111",
+            string);
+    TEST_ASSERT_EQUAL(13, ulong_long_to_base_strn(string, sizeof(string),
+                ULLONG_MAX, 36, 0));
+    TEST_ASSERT_EQUAL_STRING("3w5e11264sgsf", string);
+    TEST_ASSERT_EQUAL(1, ulong_long_to_base_strn(string, sizeof(string),
+                0, 7, 0));
+    TEST_ASSERT_EQUAL_STRING("0", string);
+    TEST_ASSERT_EQUAL(4, ulong_long_to_base_strn(string, sizeof(string),
+                48, 3, 0));
+    TEST_ASSERT_EQUAL_STRING("1210", string);
+
+    // invalid base
+    g_remaining_asserts = 1;
+    TEST_ASSERT_EQUAL(0, ulong_long_to_base_strn(string, sizeof(string),
+                10, 37, 0));
+    TEST_ASSERT_EQUAL(0, g_remaining_asserts);
+    TEST_ASSERT_EQUAL_STRING("", string);
+}
+
+void test_ulong_long_to_hex_strn__small_buffer__truncates(void)
+{
+    char string[8];
+
+    // padding and digits are both cut off
+    memset(string, 0x33, sizeof(string));
+    TEST_ASSERT_EQUAL(8, ulong_long_to_hex_strn(string, 6, 0xBEEF, 8, true));
+    TEST_ASSERT_EQUAL_STRING("0000B", string);
+    TEST_ASSERT_EQUAL(0x33, string[6]);
+    TEST_ASSERT_EQUAL(8, ulong_long_to_hex_strn(string, 3, 0xBEEF, 8, true));
+    TEST_ASSERT_EQUAL_STRING("00", string);
+
+    // exactly fits
+    TEST_ASSERT_EQUAL(7, ulong_long_to_hex_strn(string, 8, 0xabcdef1, 0,
+                false));
+    TEST_ASSERT_EQUAL_STRING("abcdef1", string);
+    TEST_ASSERT_EQUAL(20, ulong_long_to_strn(string, 8, ULLONG_MAX));
+    TEST_ASSERT_EQUAL_STRING("1844674", string);
+}
+
+void test_int_array_to_strn__writes_whole_values(void)
+{
+    const int64_t values[] = {0, -1, INT64_MAX, INT64_MIN, 42, 1000000};
+    const size_t count = sizeof(values)/sizeof(values[0]);
+    char string[256];
+    char buf[256];
+
+    // same as snprintf() per value, joined by the separator
+    size_t len = 0;
+    buf[0] = '\0';
+    for(size_t i=0; i<count; i++) {
+        size_t used = strlen(buf);
+        snprintf(buf + used, sizeof(buf) - used, "%s%lld", i ? ", " : "",
+                (long long)values[i]);
+    }
+    TEST_ASSERT_EQUAL(count, int64_array_to_strn(values, count, string,
+                sizeof(string), ", ", &len));
+    TEST_ASSERT_EQUAL_STRING(buf, string);
+    TEST_ASSERT_EQUAL(strlen(buf), len);
+
+    // "0, -1, 9223372036854775807": the third value does not fit,
+    // neither does its separator
+    char small[20];
+    memset(small, 0x33, sizeof(small));
+    TEST_ASSERT_EQUAL(2, int64_array_to_strn(values, count, small,
+                sizeof(small), ", ", &len));
+    TEST_ASSERT_EQUAL_STRING("0, -1", small);
+    TEST_ASSERT_EQUAL(5, len);
+
+    // continue where it stopped
+    TEST_ASSERT_EQUAL(1, int64_array_to_strn(values + 2, count - 2, small,
+                sizeof(small), ", ", &len));
+    TEST_ASSERT_EQUAL_STRING("9223372036854775807", small);
+    TEST_ASSERT_EQUAL(0, int64_array_to_strn(values + 3, count - 3, small,
+                sizeof(small), ", ", &len));
+    TEST_ASSERT_EQUAL_STRING("", small);
+    TEST_ASSERT_EQUAL(2, int64_array_to_strn(values + 4, count - 4, small,
+                sizeof(small), ", ", &len));
+    TEST_ASSERT_EQUAL_STRING("42, 1000000", small);
+
+    // 32-bit values, no separator, empty buffer
+    const int32_t values32[] = {INT32_MIN, 7, INT32_MAX};
+    TEST_ASSERT_EQUAL(3, int32_array_to_strn(values32, 3, string,
+                sizeof(string), NULL, NULL));
+    TEST_ASSERT_EQUAL_STRING("-214748364872147483647", string);
+    TEST_ASSERT_EQUAL(3, int32_array_to_strn(values32, 3, string,
+                sizeof(string), "\t", &len));
+    TEST_ASSERT_EQUAL_STRING("-2147483648\t7\t2147483647", string);
+    TEST_ASSERT_EQUAL(0, int32_array_to_strn(values32, 3, string, 0, ",",
+                &len));
+    TEST_ASSERT_EQUAL(0, len);
+}
 
 
 int main(void)
 {
     UNITY_BEGIN();
     RUN_TEST(test__hardcoded__match);
+    RUN_TEST(test_long_long_to_strn__matches_snprintf);
+    RUN_TEST(test_long_long_to_strn__small_buffer__truncates);
+    RUN_TEST(test_ulong_long_to_strn__formats_match_snprintf);
+    RUN_TEST(test_ulong_long_to_base_strn__hardcoded__match);
+    RUN_TEST(test_ulong_long_to_hex_strn__small_buffer__truncates);
+    RUN_TEST(test_int_array_to_strn__writes_whole_values);
     UNITY_END();
 
 
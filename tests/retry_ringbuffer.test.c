@@ -265,6 +265,529 @@ void test_write_with_dual_overwrites()
 
 }
 
+void test_unordered_complete_write(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*1];
+    uint32_t write_done[RETRY_RINGBUFFER_BITMAP_WORDS(4)];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, write_done, NULL);
+
+    char *w1 = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+    char *w2 = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+    char *w3 = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+    *w1 = 'A';
+    *w2 = 'B';
+    *w3 = 'C';
+
+    // newer writes complete first: nothing is readable yet
+    retry_ringbuffer_complete_write(&la_rb, w3);
+    retry_ringbuffer_complete_write(&la_rb, w2);
+    TEST_ASSERT_EQUAL(0, ringbuffer_used_count(&rb));
+    TEST_ASSERT_NULL(retry_ringbuffer_claim_read_ptr(&la_rb));
+
+    // oldest write completes: the whole prefix becomes readable
+    retry_ringbuffer_complete_write(&la_rb, w1);
+    TEST_ASSERT_EQUAL(3, ringbuffer_used_count(&rb));
+
+    char *r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('A', *r);
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('B', *r);
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('C', *r);
+
+    // expect assertion failure: cannot complete the same write twice
+    w1 = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+    w2 = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+    retry_ringbuffer_complete_write(&la_rb, w2);
+    g_remaining_asserts = 1;
+    retry_ringbuffer_complete_write(&la_rb, w2);
+    TEST_ASSERT_EQUAL(0, g_remaining_asserts);
+}
+
+void test_unordered_complete_read(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*1];
+    uint32_t read_done[RETRY_RINGBUFFER_BITMAP_WORDS(4)];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, NULL, read_done);
+
+    ringbuffer_write(&rb, "ABCD", 4);
+
+    char *r1 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    char *r2 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    char *r3 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('C', *r3);
+
+    // newer reads complete first: no space is freed yet
+    retry_ringbuffer_complete_read(&la_rb, r2);
+    retry_ringbuffer_complete_read(&la_rb, r3);
+    TEST_ASSERT_EQUAL(0, ringbuffer_free_count(&rb));
+    TEST_ASSERT_EQUAL(1, la_rb.num_reads);
+
+    // oldest read completes: the whole prefix is freed
+    retry_ringbuffer_complete_read(&la_rb, r1);
+    TEST_ASSERT_EQUAL(3, ringbuffer_free_count(&rb));
+    TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+
+    char *r4 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('D', *r4);
+    TEST_ASSERT_NULL(retry_ringbuffer_claim_read_ptr(&la_rb));
+
+    // expect assertion failure: cannot complete an unclaimed read
+    g_remaining_asserts = 1;
+    retry_ringbuffer_complete_read(&la_rb, r1);
+    TEST_ASSERT_EQUAL(0, g_remaining_asserts);
+}
+
+void test_unordered_cancel_all_reads__skips_completed(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*1];
+    uint32_t read_done[RETRY_RINGBUFFER_BITMAP_WORDS(4)];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, NULL, read_done);
+
+    ringbuffer_write(&rb, "ABCD", 4);
+
+    retry_ringbuffer_claim_read_ptr(&la_rb);
+    char *r2 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    retry_ringbuffer_claim_read_ptr(&la_rb);
+    retry_ringbuffer_complete_read(&la_rb, r2);
+
+    // canceled reads are claimed again, but the completed one is skipped
+    retry_ringbuffer_cancel_all_reads(&la_rb);
+    char *r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('A', *r);
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('C', *r);
+
+    // cancel the last claim: 'C' is claimed again
+    retry_ringbuffer_cancel_read(&la_rb, r);
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('C', *r);
+
+    retry_ringbuffer_complete_all_reads(&la_rb);
+    TEST_ASSERT_EQUAL(3, ringbuffer_free_count(&rb));
+
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('D', *r);
+}
+
+void test_claim_reads__wraps_in_two_spans(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*2];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 2, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init(&la_rb, &rb);
+
+    RetryRingbufferSpans spans;
+
+    // nothing to claim yet
+    TEST_ASSERT_EQUAL(0, retry_ringbuffer_claim_reads(&la_rb, 8, &spans));
+    TEST_ASSERT_EQUAL(0, spans.count[0]);
+    TEST_ASSERT_NULL(spans.ptr[0]);
+
+    ringbuffer_write(&rb, "AABBCC", 3);
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claim_reads(&la_rb, 2, &spans));
+    TEST_ASSERT_EQUAL_PTR(&buffer[0], spans.ptr[0]);
+    TEST_ASSERT_EQUAL(2, spans.count[0]);
+    TEST_ASSERT_EQUAL(0, spans.count[1]);
+    retry_ringbuffer_complete_reads(&la_rb, 2);
+    TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+    TEST_ASSERT_EQUAL(1, ringbuffer_used_count(&rb));
+
+    // 'CC' at the end of the buffer, 'DD' and 'EE' wrapped to the start
+    ringbuffer_write(&rb, "DDEE", 2);
+    TEST_ASSERT_EQUAL(3, retry_ringbuffer_claim_reads(&la_rb, 8, &spans));
+    TEST_ASSERT_EQUAL_PTR(&buffer[4], spans.ptr[0]);
+    TEST_ASSERT_EQUAL(2, spans.count[0]);
+    TEST_ASSERT_EQUAL_PTR(&buffer[0], spans.ptr[1]);
+    TEST_ASSERT_EQUAL(1, spans.count[1]);
+    TEST_ASSERT_EQUAL(3, la_rb.num_reads);
+
+    // cancel the latest two: they are claimed again
+    retry_ringbuffer_cancel_reads(&la_rb, 2);
+    TEST_ASSERT_EQUAL(1, la_rb.num_reads);
+    char *r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('D', *r);
+
+    retry_ringbuffer_complete_all_reads(&la_rb);
+    TEST_ASSERT_EQUAL(1, ringbuffer_used_count(&rb));
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('E', *r);
+
+    // expect assertion failure: cannot complete more than claimed
+    g_remaining_asserts = 1;
+    retry_ringbuffer_complete_reads(&la_rb, 2);
+    TEST_ASSERT_EQUAL(0, g_remaining_asserts);
+}
+
+void test_claim_reads__stops_at_completed(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*1];
+    uint32_t read_done[RETRY_RINGBUFFER_BITMAP_WORDS(4)];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, NULL, read_done);
+
+    ringbuffer_write(&rb, "ABCD", 4);
+
+    RetryRingbufferSpans spans;
+    TEST_ASSERT_EQUAL(4, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+    retry_ringbuffer_complete_read(&la_rb, &buffer[1]);
+    retry_ringbuffer_cancel_all_reads(&la_rb);
+
+    // 'B' was completed: batches are split around it
+    TEST_ASSERT_EQUAL(1, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+    TEST_ASSERT_EQUAL_PTR(&buffer[0], spans.ptr[0]);
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+    TEST_ASSERT_EQUAL_PTR(&buffer[2], spans.ptr[0]);
+
+    retry_ringbuffer_complete_reads(&la_rb, 3);
+    TEST_ASSERT_EQUAL(4, ringbuffer_free_count(&rb));
+    TEST_ASSERT_TRUE(retry_ringbuffer_is_empty(&la_rb));
+}
+
+void test_claim_writes(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[3*1];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 3);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init(&la_rb, &rb);
+
+    RetryRingbufferSpans spans;
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claim_writes(&la_rb, 2, &spans));
+    memcpy(spans.ptr[0], "AB", 2);
+    retry_ringbuffer_complete_writes(&la_rb, 2);
+    TEST_ASSERT_EQUAL(2, ringbuffer_used_count(&rb));
+
+    ringbuffer_flush(&rb, 2);
+
+    // claim wraps around: 1 element at the end, 2 at the start
+    TEST_ASSERT_EQUAL(3, retry_ringbuffer_claim_writes(&la_rb, 8, &spans));
+    TEST_ASSERT_EQUAL_PTR(&buffer[2], spans.ptr[0]);
+    TEST_ASSERT_EQUAL(1, spans.count[0]);
+    TEST_ASSERT_EQUAL_PTR(&buffer[0], spans.ptr[1]);
+    TEST_ASSERT_EQUAL(2, spans.count[1]);
+    TEST_ASSERT_TRUE(retry_ringbuffer_is_full(&la_rb));
+
+    memcpy(spans.ptr[0], "C", 1);
+
+    // full: nothing more to claim
+    TEST_ASSERT_EQUAL(0, retry_ringbuffer_claim_writes(&la_rb, 1, &spans));
+    TEST_ASSERT_NULL(spans.ptr[0]);
+
+    retry_ringbuffer_cancel_writes(&la_rb, 2);
+    retry_ringbuffer_complete_writes(&la_rb, 1);
+    TEST_ASSERT_EQUAL(1, ringbuffer_used_count(&rb));
+
+    char c;
+    TEST_ASSERT_EQUAL(1, ringbuffer_read(&rb, &c, 1));
+    TEST_ASSERT_EQUAL_CHAR('C', c);
+
+    // expect assertion failure: cannot complete more than claimed
+    g_remaining_asserts = 1;
+    retry_ringbuffer_complete_writes(&la_rb, 1);
+    TEST_ASSERT_EQUAL(0, g_remaining_asserts);
+}
+
+static uint32_t g_now = 0;
+
+static uint32_t test_clock(void)
+{
+    return g_now;
+}
+
+void test_lease__expired_reads_are_requeued(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*1];
+    uint32_t read_done[RETRY_RINGBUFFER_BITMAP_WORDS(4)];
+    uint32_t deadlines[4];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, NULL, read_done);
+
+    // deadlines should work across clock wraparound
+    g_now = UINT32_MAX - 5;
+    retry_ringbuffer_enable_lease(&la_rb, deadlines, 10, test_clock);
+
+    ringbuffer_write(&rb, "ABCD", 4);
+
+    char *r1 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    g_now+= 5;
+    char *r2 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    char *r3 = retry_ringbuffer_claim_read_ptr(&la_rb);
+    retry_ringbuffer_complete_read(&la_rb, r2);
+    const uint32_t epoch = retry_ringbuffer_lease_epoch(&la_rb);
+
+    // lease of r1 not yet expired
+    g_now+= 4;
+    TEST_ASSERT_EQUAL(0, retry_ringbuffer_requeue_expired(&la_rb));
+    TEST_ASSERT_EQUAL(2, la_rb.num_reads);
+
+    // lease of r1 expired: next claim hands out r1 again, r2 is skipped
+    g_now+= 1;
+    char *r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_PTR(r1, r);
+    TEST_ASSERT_EQUAL(1, la_rb.num_reads);
+    TEST_ASSERT_TRUE(epoch != retry_ringbuffer_lease_epoch(&la_rb));
+
+    // late complete of the expired (unclaimed) r3 has no effect
+    retry_ringbuffer_complete_read(&la_rb, r3);
+    TEST_ASSERT_EQUAL(1, la_rb.num_reads);
+    TEST_ASSERT_EQUAL(0, ringbuffer_free_count(&rb));
+
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_PTR(r3, r);
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('D', *r);
+
+    // the new leases have not expired yet
+    g_now+= 9;
+    TEST_ASSERT_EQUAL(0, retry_ringbuffer_requeue_expired(&la_rb));
+    retry_ringbuffer_complete_all_reads(&la_rb);
+    TEST_ASSERT_EQUAL(4, ringbuffer_free_count(&rb));
+    TEST_ASSERT_EQUAL(0, retry_ringbuffer_requeue_expired(&la_rb));
+}
+
+void test_seq__ack_up_to_and_nack(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*1];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init(&la_rb, &rb);
+
+    // sequence numbers keep counting when the ringbuffer wraps
+    RetryRingbufferSpans spans;
+    for(size_t round=0; round<3; round++) {
+        TEST_ASSERT_EQUAL(4, retry_ringbuffer_claim_writes(&la_rb, 4, &spans));
+        TEST_ASSERT_EQUAL(round*4, spans.seq);
+        retry_ringbuffer_complete_writes(&la_rb, 4);
+
+        TEST_ASSERT_EQUAL(4, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+        TEST_ASSERT_EQUAL(round*4, spans.seq);
+        TEST_ASSERT_EQUAL(round*4 + 1,
+                retry_ringbuffer_seq(&la_rb, buffer + 1));
+        retry_ringbuffer_ack_up_to(&la_rb, round*4 + 3);
+        TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+        TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+    }
+
+    ringbuffer_write(&rb, "ABCD", 4);
+    TEST_ASSERT_EQUAL(4, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+    TEST_ASSERT_EQUAL(12, spans.seq);
+
+    // cumulative ack releases the oldest two, stale acks are ignored
+    retry_ringbuffer_ack_up_to(&la_rb, 13);
+    retry_ringbuffer_ack_up_to(&la_rb, 12);
+    TEST_ASSERT_EQUAL(2, ringbuffer_free_count(&rb));
+    TEST_ASSERT_EQUAL(2, la_rb.num_reads);
+
+    // go-back-N: 14 and 15 are handed out again
+    retry_ringbuffer_nack(&la_rb, 14);
+    retry_ringbuffer_nack(&la_rb, 15);
+    TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+    char *r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('C', *r);
+    TEST_ASSERT_EQUAL(14, retry_ringbuffer_seq(&la_rb, r));
+
+    // a late ack may cover requeued elements that are not claimed
+    retry_ringbuffer_ack_up_to(&la_rb, 15);
+    TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+    TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+    TEST_ASSERT_TRUE(retry_ringbuffer_is_empty(&la_rb));
+
+    // expect assertion failure: cannot ack elements that were never written
+    g_remaining_asserts = 1;
+    retry_ringbuffer_ack_up_to(&la_rb, 16);
+    TEST_ASSERT_EQUAL(0, g_remaining_asserts);
+}
+
+void test_seq__selective_ack(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[4*1];
+    uint32_t read_done[RETRY_RINGBUFFER_BITMAP_WORDS(4)];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 4);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, NULL, read_done);
+
+    ringbuffer_write(&rb, "ABCD", 4);
+    RetryRingbufferSpans spans;
+    TEST_ASSERT_EQUAL(4, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+
+    // selective ack of 1 and 3, then go-back-N from 0
+    retry_ringbuffer_ack(&la_rb, 1);
+    retry_ringbuffer_ack(&la_rb, 3);
+    retry_ringbuffer_ack(&la_rb, 3);
+    TEST_ASSERT_EQUAL(2, la_rb.num_reads);
+    retry_ringbuffer_nack(&la_rb, 0);
+    TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+
+    // acked elements are not handed out again
+    TEST_ASSERT_EQUAL(1, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+    TEST_ASSERT_EQUAL(0, spans.seq);
+    TEST_ASSERT_EQUAL(1, retry_ringbuffer_claim_reads(&la_rb, 4, &spans));
+    TEST_ASSERT_EQUAL(2, spans.seq);
+    TEST_ASSERT_EQUAL(2, la_rb.num_reads);
+
+    // requeue 2, then ack it before it is claimed again
+    retry_ringbuffer_nack(&la_rb, 2);
+    TEST_ASSERT_EQUAL(1, la_rb.num_reads);
+    retry_ringbuffer_ack(&la_rb, 2);
+    TEST_ASSERT_NULL(retry_ringbuffer_claim_read_ptr(&la_rb));
+
+    retry_ringbuffer_ack(&la_rb, 0);
+    TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+    TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+    TEST_ASSERT_EQUAL(4, ringbuffer_free_count(&rb));
+}
+
+void test_drop_policy__stats(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[2*1];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 2);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init(&la_rb, &rb);
+
+    RetryRingbufferStats stats;
+    RetryRingbufferSpans spans;
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claim_writes(&la_rb, 2, &spans));
+    memcpy(spans.ptr[0], "AB", 2);
+    retry_ringbuffer_complete_writes(&la_rb, 2);
+
+    // block: nothing is discarded
+    retry_ringbuffer_set_drop_policy(&la_rb, RETRY_RINGBUFFER_BLOCK);
+    TEST_ASSERT_NULL(retry_ringbuffer_wrapping_write_ptr(&la_rb));
+    TEST_ASSERT_NULL(retry_ringbuffer_wrapping_write_ptr(&la_rb));
+    retry_ringbuffer_get_stats(&la_rb, &stats);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    TEST_ASSERT_EQUAL(2, stats.blocked);
+
+    // drop newest: the new element is discarded
+    retry_ringbuffer_set_drop_policy(&la_rb, RETRY_RINGBUFFER_DROP_NEWEST);
+    TEST_ASSERT_NULL(retry_ringbuffer_wrapping_write_ptr(&la_rb));
+    retry_ringbuffer_get_stats(&la_rb, &stats);
+    TEST_ASSERT_EQUAL(1, stats.dropped);
+    TEST_ASSERT_EQUAL(0, stats.dropped_in_flight);
+
+    // drop oldest: unclaimed 'A', then claimed (in-flight) 'B' are discarded
+    retry_ringbuffer_set_drop_policy(&la_rb, RETRY_RINGBUFFER_DROP_OLDEST);
+    char *w = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+    *w = 'C';
+    retry_ringbuffer_complete_write(&la_rb, w);
+
+    char *r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('B', *r);
+    w = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+    *w = 'D';
+    retry_ringbuffer_complete_write(&la_rb, w);
+
+    retry_ringbuffer_get_stats(&la_rb, &stats);
+    TEST_ASSERT_EQUAL(3, stats.dropped);
+    TEST_ASSERT_EQUAL(1, stats.dropped_in_flight);
+    TEST_ASSERT_EQUAL(2, stats.blocked);
+
+    r = retry_ringbuffer_claim_read_ptr(&la_rb);
+    TEST_ASSERT_EQUAL_CHAR('C', *r);
+
+    retry_ringbuffer_reset_stats(&la_rb);
+    retry_ringbuffer_get_stats(&la_rb, &stats);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    TEST_ASSERT_EQUAL(0, stats.dropped_in_flight);
+    TEST_ASSERT_EQUAL(0, stats.blocked);
+}
+
+void test_claimers__share_one_ringbuffer(void)
+{
+    g_remaining_asserts = 0;
+
+    uint8_t buffer[8*1];
+    uint32_t read_done[RETRY_RINGBUFFER_BITMAP_WORDS(8)];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, 1, 8);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, NULL, read_done);
+    RetryRingbufferClaimer a, b;
+    retry_ringbuffer_claimer_init(&a, &la_rb);
+    retry_ringbuffer_claimer_init(&b, &la_rb);
+
+    ringbuffer_write(&rb, "ABCDEFGH", 8);
+
+    RetryRingbufferSpans spans;
+    TEST_ASSERT_EQUAL(3, retry_ringbuffer_claimer_claim(&a, 3, &spans));
+    TEST_ASSERT_EQUAL_CHAR('A', *(char *)spans.ptr[0]);
+    TEST_ASSERT_EQUAL(3, retry_ringbuffer_claimer_claim(&b, 3, &spans));
+    TEST_ASSERT_EQUAL_CHAR('D', *(char *)spans.ptr[0]);
+
+    // slots are released up to the oldest incomplete read of all claimers
+    retry_ringbuffer_claimer_complete(&b, 3);
+    TEST_ASSERT_EQUAL(0, ringbuffer_free_count(&rb));
+    retry_ringbuffer_claimer_complete(&a, 1);
+    TEST_ASSERT_EQUAL(1, ringbuffer_free_count(&rb));
+
+    // newer reads are claimed: the rest of the window is parked
+    retry_ringbuffer_claimer_cancel(&a);
+    TEST_ASSERT_EQUAL(2, la_rb.num_reads);
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claimer_claim(&b, 4, &spans));
+    TEST_ASSERT_EQUAL_CHAR('B', *(char *)spans.ptr[0]);
+    TEST_ASSERT_EQUAL(1, spans.seq);
+
+    // latest window: canceled directly
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claimer_claim(&a, 4, &spans));
+    TEST_ASSERT_EQUAL_CHAR('G', *(char *)spans.ptr[0]);
+    retry_ringbuffer_claimer_cancel(&a);
+    TEST_ASSERT_EQUAL(2, la_rb.num_reads);
+
+    retry_ringbuffer_claimer_complete(&b, 2);
+    TEST_ASSERT_EQUAL(6, ringbuffer_free_count(&rb));
+    TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+
+    // requeued windows can no longer be completed
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claimer_claim(&a, 4, &spans));
+    retry_ringbuffer_cancel_all_reads(&la_rb);
+    retry_ringbuffer_claimer_complete(&a, 2);
+    TEST_ASSERT_EQUAL(6, ringbuffer_free_count(&rb));
+
+    TEST_ASSERT_EQUAL(2, retry_ringbuffer_claimer_claim(&b, 4, &spans));
+    TEST_ASSERT_EQUAL_CHAR('G', *(char *)spans.ptr[0]);
+    retry_ringbuffer_claimer_complete(&b, 2);
+    TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+    TEST_ASSERT_EQUAL(0, retry_ringbuffer_claimer_claim(&a, 4, &spans));
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -276,6 +799,17 @@ int main(void)
     RUN_TEST(test_reproduce_bug);
     RUN_TEST(test_write_without_reads);
     RUN_TEST(test_write_with_dual_overwrites);
+    RUN_TEST(test_unordered_complete_write);
+    RUN_TEST(test_unordered_complete_read);
+    RUN_TEST(test_unordered_cancel_all_reads__skips_completed);
+    RUN_TEST(test_claim_reads__wraps_in_two_spans);
+    RUN_TEST(test_claim_reads__stops_at_completed);
+    RUN_TEST(test_claim_writes);
+    RUN_TEST(test_lease__expired_reads_are_requeued);
+    RUN_TEST(test_seq__ack_up_to_and_nack);
+    RUN_TEST(test_seq__selective_ack);
+    RUN_TEST(test_drop_policy__stats);
+    RUN_TEST(test_claimers__share_one_ringbuffer);
 
 
     // RUN_TEST(test_claim_write);
@@ -0,0 +1,361 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "unity.h"
+#include "retry_ringbuffer.h"
+
+/* Soak test for retry_ringbuffer: a lossy link is simulated with a
+ * deterministic PRNG, so every run with the same settings is identical.
+ * The receiving side checks that elements arrive in FIFO order without loss
+ * (or, with wrapping writes, that every element is either delivered or
+ * counted as dropped). Goodput, redelivery overhead and claims/s are printed.
+ *
+ * The defaults make a short run, override them for a soak or a benchmark:
+ * e.g. -DSTRESS_ELEMENTS=10000000 -DSTRESS_FAIL_PERCENT=20
+ */
+
+#ifndef STRESS_ELEMENTS
+#define STRESS_ELEMENTS         (20000)     // elements sent per test
+#endif
+#ifndef STRESS_RING_COUNT
+#define STRESS_RING_COUNT       (64)        // ringbuffer size (elements)
+#endif
+#ifndef STRESS_ELEM_SIZE
+#define STRESS_ELEM_SIZE        (16)        // element size, at least 8
+#endif
+#ifndef STRESS_MAX_CLAIM
+#define STRESS_MAX_CLAIM        (16)        // maximum claim depth
+#endif
+#ifndef STRESS_FAIL_PERCENT
+#define STRESS_FAIL_PERCENT     (5)         // chance an element gets lost
+#endif
+#ifndef STRESS_CANCEL_PERCENT
+#define STRESS_CANCEL_PERCENT   (10)        // chance a whole claim is canceled
+#endif
+#ifndef STRESS_SEED
+#define STRESS_SEED             (0x2545F491)
+#endif
+
+int g_remaining_asserts = 0;
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+void assert(bool sane)
+{
+    if(g_remaining_asserts) {
+        if(!sane) {
+            g_remaining_asserts--;
+        }
+    } else {
+        TEST_ASSERT_MESSAGE(sane, "Assertion failed!");
+    }
+}
+
+static uint32_t g_rand_state;
+
+// xorshift32: deterministic and fast
+static uint32_t rand_next(void)
+{
+    uint32_t x = g_rand_state;
+    x^= x << 13;
+    x^= x >> 17;
+    x^= x << 5;
+    g_rand_state = x;
+    return x;
+}
+
+static bool rand_percent(uint32_t percent)
+{
+    return (rand_next() % 100) < percent;
+}
+
+// random amount in [1, max]
+static uint32_t rand_count(uint32_t max)
+{
+    return 1 + (rand_next() % max);
+}
+
+typedef struct {
+    uint32_t sent;          // elements handed to the link (incl. resends)
+    uint32_t delivered;     // elements completed
+    uint32_t claims;        // calls that claimed at least one element
+    clock_t start;
+} StressStats;
+
+static void stats_start(StressStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    g_rand_state = STRESS_SEED;
+    stats->start = clock();
+}
+
+static void stats_print(const char *name, const StressStats *stats)
+{
+    const double seconds = (double)(clock() - stats->start) / CLOCKS_PER_SEC;
+    const double goodput = stats->sent
+        ? (100.0 * stats->delivered / stats->sent) : 0.0;
+    const double redelivery = stats->delivered
+        ? (100.0 * (stats->sent - stats->delivered) / stats->delivered) : 0.0;
+
+    printf("%s: %u delivered, goodput %.1f%%, redelivery %.1f%%, "
+            "%.0f claims/s\n", name, stats->delivered, goodput, redelivery,
+            (seconds > 0) ? (stats->claims / seconds) : 0.0);
+}
+
+static void elem_write(uint8_t *elem, uint32_t seq)
+{
+    const uint32_t inv = ~seq;
+    memcpy(elem, &seq, sizeof(seq));
+    memcpy(elem + sizeof(seq), &inv, sizeof(inv));
+}
+
+// return the sequence number stored in the element, check it is intact
+static uint32_t elem_read(const uint8_t *elem)
+{
+    uint32_t seq, inv;
+    memcpy(&seq, elem, sizeof(seq));
+    memcpy(&inv, elem + sizeof(seq), sizeof(inv));
+    TEST_ASSERT_EQUAL_UINT32(~seq, inv);
+    return seq;
+}
+
+// write a random amount of elements, as far as they fit
+static void produce(RetryRingbuffer *ctx, uint32_t *produced)
+{
+    RetryRingbufferSpans spans;
+    const uint32_t want = rand_count(STRESS_MAX_CLAIM);
+    const uint32_t left = STRESS_ELEMENTS - *produced;
+
+    const uint32_t count = retry_ringbuffer_claim_writes(ctx,
+            (want < left) ? want : left, &spans);
+    for(size_t s=0; s<2; s++) {
+        for(uint32_t i=0; i<spans.count[s]; i++) {
+            elem_write((uint8_t *)spans.ptr[s] + (i * STRESS_ELEM_SIZE),
+                    (*produced)++);
+        }
+    }
+    retry_ringbuffer_complete_writes(ctx, count);
+}
+
+// Go-back-N over a lossy link: the receiver acks up to the first lost
+// element, which is then sent again together with everything after it.
+void test_stress__go_back_n(void)
+{
+    g_remaining_asserts = 0;
+
+    static uint8_t buffer[STRESS_RING_COUNT * STRESS_ELEM_SIZE];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, STRESS_ELEM_SIZE, STRESS_RING_COUNT);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init(&la_rb, &rb);
+
+    StressStats stats;
+    stats_start(&stats);
+
+    uint32_t produced = 0;
+    while(stats.delivered < STRESS_ELEMENTS) {
+        produce(&la_rb, &produced);
+
+        RetryRingbufferSpans spans;
+        const uint32_t count = retry_ringbuffer_claim_reads(&la_rb,
+                rand_count(STRESS_MAX_CLAIM), &spans);
+        if(!count) {
+            continue;
+        }
+        stats.claims++;
+
+        if(rand_percent(STRESS_CANCEL_PERCENT)) {
+            retry_ringbuffer_cancel_reads(&la_rb, count);
+            continue;
+        }
+
+        // receiver: accepts elements in order up to the first lost one
+        const uint32_t sent = stats.sent;
+        uint32_t received = 0;
+        bool lost = false;
+        for(size_t s=0; s<2; s++) {
+            for(uint32_t i=0; i<spans.count[s]; i++) {
+                const uint32_t seq = elem_read((uint8_t *)spans.ptr[s]
+                        + (i * STRESS_ELEM_SIZE));
+                TEST_ASSERT_EQUAL_UINT32(spans.seq + stats.sent - sent, seq);
+                stats.sent++;
+
+                lost = lost || rand_percent(STRESS_FAIL_PERCENT);
+                if(!lost) {
+                    // FIFO without loss: exactly the next element
+                    TEST_ASSERT_EQUAL_UINT32(stats.delivered, seq);
+                    stats.delivered++;
+                    received++;
+                }
+            }
+        }
+
+        if(received) {
+            retry_ringbuffer_ack_up_to(&la_rb, spans.seq + received - 1);
+        }
+        if(lost) {
+            retry_ringbuffer_nack(&la_rb, spans.seq + received);
+        }
+        TEST_ASSERT_EQUAL(0, la_rb.num_reads);
+    }
+
+    TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+    stats_print("go-back-N", &stats);
+}
+
+// Selective repeat: every element that arrives is completed out-of-order,
+// the lost elements are canceled and sent again.
+void test_stress__selective_repeat(void)
+{
+    g_remaining_asserts = 0;
+
+    static uint8_t buffer[STRESS_RING_COUNT * STRESS_ELEM_SIZE];
+    static uint32_t read_done[RETRY_RINGBUFFER_BITMAP_WORDS(STRESS_RING_COUNT)];
+    static bool received[STRESS_ELEMENTS];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, STRESS_ELEM_SIZE, STRESS_RING_COUNT);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init_unordered(&la_rb, &rb, NULL, read_done);
+    memset(received, 0, sizeof(received));
+
+    StressStats stats;
+    stats_start(&stats);
+
+    uint32_t produced = 0;
+    uint64_t released = 0;
+    while(stats.delivered < STRESS_ELEMENTS) {
+        produce(&la_rb, &produced);
+
+        void *claimed[STRESS_MAX_CLAIM];
+        uint32_t count = 0;
+        const uint32_t depth = rand_count(STRESS_MAX_CLAIM);
+        while(count < depth) {
+            void *r = retry_ringbuffer_claim_read_ptr(&la_rb);
+            if(!r) {
+                break;
+            }
+            claimed[count++] = r;
+        }
+        if(!count) {
+            continue;
+        }
+        stats.claims++;
+
+        if(rand_percent(STRESS_CANCEL_PERCENT)) {
+            retry_ringbuffer_cancel_reads(&la_rb, count);
+            continue;
+        }
+
+        // complete in random order (Fisher-Yates shuffle)
+        for(uint32_t i=count-1; i>0; i--) {
+            const uint32_t j = rand_next() % (i + 1);
+            void *tmp = claimed[i];
+            claimed[i] = claimed[j];
+            claimed[j] = tmp;
+        }
+        for(uint32_t i=0; i<count; i++) {
+            void *r = claimed[i];
+            stats.sent++;
+
+            if(rand_percent(STRESS_FAIL_PERCENT)) {
+                continue;
+            }
+            const uint32_t seq = elem_read(r);
+            TEST_ASSERT_FALSE(received[seq]);
+            received[seq] = true;
+            stats.delivered++;
+            retry_ringbuffer_complete_read(&la_rb, r);
+        }
+        retry_ringbuffer_cancel_all_reads(&la_rb);
+
+        // slots are released in FIFO order, only after delivery
+        const uint64_t read_seq = la_rb.read_seq;
+        TEST_ASSERT_TRUE(read_seq >= released);
+        for(; released < read_seq; released++) {
+            TEST_ASSERT_TRUE(received[released]);
+        }
+    }
+
+    TEST_ASSERT_TRUE(ringbuffer_is_empty(&rb));
+    stats_print("selective repeat", &stats);
+}
+
+// Wrapping writes: the producer never waits, the oldest elements are
+// dropped. Every element is either delivered (in order) or counted.
+void test_stress__wrapping_writes(void)
+{
+    g_remaining_asserts = 0;
+
+    static uint8_t buffer[STRESS_RING_COUNT * STRESS_ELEM_SIZE];
+    Ringbuffer rb;
+    ringbuffer_init(&rb, buffer, STRESS_ELEM_SIZE, STRESS_RING_COUNT);
+    RetryRingbuffer la_rb;
+    retry_ringbuffer_init(&la_rb, &rb);
+
+    StressStats stats;
+    stats_start(&stats);
+
+    uint32_t produced = 0;
+    int64_t last_seq = -1;
+    while(produced < STRESS_ELEMENTS || !ringbuffer_is_empty(&rb)) {
+
+        // bursts of up to twice the claim depth overflow the ringbuffer
+        const uint32_t burst = rand_count(2 * STRESS_MAX_CLAIM);
+        for(uint32_t i=0; (i < burst) && (produced < STRESS_ELEMENTS); i++) {
+            uint8_t *w = retry_ringbuffer_wrapping_write_ptr(&la_rb);
+            TEST_ASSERT_NOT_NULL(w);
+            elem_write(w, produced++);
+            retry_ringbuffer_complete_write(&la_rb, w);
+        }
+
+        RetryRingbufferSpans spans;
+        const uint32_t count = retry_ringbuffer_claim_reads(&la_rb,
+                rand_count(STRESS_MAX_CLAIM), &spans);
+        if(!count) {
+            continue;
+        }
+        stats.claims++;
+        stats.sent+= count;
+
+        if(rand_percent(STRESS_FAIL_PERCENT + STRESS_CANCEL_PERCENT)) {
+            retry_ringbuffer_cancel_reads(&la_rb, count);
+            continue;
+        }
+        for(size_t s=0; s<2; s++) {
+            for(uint32_t i=0; i<spans.count[s]; i++) {
+                const uint32_t seq = elem_read((uint8_t *)spans.ptr[s]
+                        + (i * STRESS_ELEM_SIZE));
+                TEST_ASSERT_TRUE((int64_t)seq > last_seq);
+                last_seq = seq;
+                stats.delivered++;
+            }
+        }
+        retry_ringbuffer_complete_reads(&la_rb, count);
+    }
+
+    RetryRingbufferStats drops;
+    retry_ringbuffer_get_stats(&la_rb, &drops);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_ELEMENTS, stats.delivered + drops.dropped);
+    TEST_ASSERT_TRUE(last_seq == (STRESS_ELEMENTS - 1));
+    stats_print("wrapping writes", &stats);
+    printf("wrapping writes: %u dropped, %u in flight\n",
+            drops.dropped, drops.dropped_in_flight);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_stress__go_back_n);
+    RUN_TEST(test_stress__selective_repeat);
+    RUN_TEST(test_stress__wrapping_writes);
+
+    UNITY_END();
+
+    return 0;
+}
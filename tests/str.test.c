@@ -4,6 +4,9 @@
 #include "str.h"
 #include "unity.h"
 #include <stdlib.h>
+#include <ctype.h>
+#include <strings.h>
+#include <time.h>
 #if defined(__linux__)
 #include <bsd/string.h>
 #endif
@@ -12,6 +15,29 @@
 void setUp(void){}
 void tearDown(void){}
 
+// Set to 1 to print a benchmark against the libc equivalents
+#ifndef RUN_STR_BENCHMARK
+#define RUN_STR_BENCHMARK (0)
+#endif
+
+static uint32_t g_rand_state = 0x2545F491;
+
+// xorshift32: deterministic and fast
+static uint32_t rand_next(void)
+{
+    uint32_t x = g_rand_state;
+    x^= x << 13;
+    x^= x >> 17;
+    x^= x << 5;
+    g_rand_state = x;
+    return x;
+}
+
+static int sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
 void test_str_toupper(void)
 {
     const char *reference = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
@@ -23,10 +49,381 @@ void test_str_toupper(void)
     TEST_ASSERT_EQUAL_MEMORY(buffer, reference, sizeof(buffer));
 }
 
+void test_str_tolower(void)
+{
+    const char *reference = "abcdefghijklmnopqrstuvwxyz0123456789@[`{";
+    const char *input = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789@[`{";
+    char buffer[strlen(input)+1];
+    strlcpy(buffer, input, sizeof(buffer));
+
+    str_tolower(buffer);
+    TEST_ASSERT_EQUAL_MEMORY(buffer, reference, sizeof(buffer));
+}
+
+void test_str_toupper_n__matches_toupper(void)
+{
+    // all byte values, every length and alignment
+    char input[300];
+    for(size_t i=0; i<sizeof(input); i++) {
+        input[i] = (char)((i * 7) + (i >> 8));
+    }
+
+    const size_t max_n = sizeof(input) - 8;
+    for(size_t offset=0; offset<8; offset++) {
+        for(size_t n=0; n<max_n; n+= (n < 40) ? 1 : 37) {
+            char upper[sizeof(input)];
+            char lower[sizeof(input)];
+            memcpy(upper, input, sizeof(input));
+            memcpy(lower, input, sizeof(input));
+            str_toupper_n(upper + offset, n);
+            str_tolower_n(lower + offset, n);
+
+            for(size_t i=0; i<sizeof(input); i++) {
+                const unsigned char c = input[i];
+                const bool converted = (i >= offset) && (i < (offset + n));
+                // only ASCII: same as the "C" locale
+                const bool ascii = (c < 0x80);
+                TEST_ASSERT_EQUAL((converted && ascii) ? toupper(c) : c,
+                        (unsigned char)upper[i]);
+                TEST_ASSERT_EQUAL((converted && ascii) ? tolower(c) : c,
+                        (unsigned char)lower[i]);
+            }
+        }
+    }
+}
+
+void test_str_toupper_n__ignores_terminator(void)
+{
+    char buffer[] = "ab\0cd\xc3\xa9" "ef";
+    str_toupper_n(buffer, 8);
+    TEST_ASSERT_EQUAL_MEMORY("AB\0CD\xc3\xa9" "Ef", buffer, 9);
+}
+
+void test_str_casecmp_n__matches_strncasecmp(void)
+{
+    TEST_ASSERT_EQUAL(0, str_casecmp_n("Content-Type", "content-type", 12));
+    TEST_ASSERT_TRUE(str_casecmp_n("abc", "ABD", 3) < 0);
+    TEST_ASSERT_TRUE(str_casecmp_n("abD", "ABC", 3) > 0);
+    TEST_ASSERT_EQUAL(0, str_casecmp_n("abD", "ABC", 2));
+    TEST_ASSERT_EQUAL(0, str_casecmp_n("x", "y", 0));
+    // '\0' is not special
+    TEST_ASSERT_TRUE(str_casecmp_n("a\0b", "A\0c", 3) < 0);
+
+    // random strings from a small alphabet, differences at any position
+    const char alphabet[] = "aAbB@[`{zZ\x7f\x80\xc3 09";
+    char a[80];
+    char b[80];
+    for(int i=0; i<20000; i++) {
+        const size_t n = rand_next() % (sizeof(a) - 1);
+        for(size_t j=0; j<n; j++) {
+            a[j] = alphabet[rand_next() % (sizeof(alphabet) - 1)];
+            b[j] = ((rand_next() % 64) == 0)
+                ? alphabet[rand_next() % (sizeof(alphabet) - 1)]
+                : (((a[j] >= 'a') && (a[j] <= 'z')) ? toupper(a[j]) : a[j]);
+        }
+        a[n] = '\0';
+        b[n] = '\0';
+        TEST_ASSERT_EQUAL(sign(strncasecmp(a, b, n)),
+                sign(str_casecmp_n(a, b, n)));
+        TEST_ASSERT_EQUAL(!strncasecmp(a, b, n), str_caseeq_n(a, n, b, n));
+    }
+
+    TEST_ASSERT_TRUE(str_caseeq_n("Host", 4, "HOST", 4));
+    TEST_ASSERT_FALSE(str_caseeq_n("Host", 4, "HOSTS", 5));
+    TEST_ASSERT_TRUE(str_caseeq_n("", 0, "", 0));
+}
+
+void test_str_find_any__finds_first_delimiter(void)
+{
+    const char *line = "key=value; other:thing,last";
+    const size_t len = strlen(line);
+
+    TEST_ASSERT_EQUAL_PTR(line + 3, str_find_any(line, len, "=", 1));
+    TEST_ASSERT_EQUAL_PTR(line + 9, str_find_any(line, len, ",;:", 3));
+    TEST_ASSERT_EQUAL_PTR(NULL, str_find_any(line, 3, "=", 1));
+    TEST_ASSERT_EQUAL_PTR(NULL, str_find_any(line, len, "#", 1));
+    TEST_ASSERT_EQUAL_PTR(NULL, str_find_any(line, len, "", 0));
+    TEST_ASSERT_EQUAL_PTR(NULL, str_find_any(line, 0, "k", 1));
+
+    // small and large sets, match at every position
+    const char large_set[] = "0123456789abcdefghij";
+    char buffer[100];
+    for(size_t set_len=1; set_len<sizeof(large_set); set_len+= 3) {
+        for(size_t pos=0; pos<=sizeof(buffer); pos++) {
+            memset(buffer, 'X', sizeof(buffer));
+            if(pos < sizeof(buffer)) {
+                buffer[pos] = large_set[set_len - 1];
+            }
+            const char *expected = (pos < sizeof(buffer))
+                ? (buffer + pos) : NULL;
+            TEST_ASSERT_EQUAL_PTR(expected, str_find_any(buffer,
+                        sizeof(buffer), large_set, set_len));
+        }
+    }
+
+    // bytes >= 0x80 and '\0' can be searched for as well
+    const char binary[] = "abc\0\xff";
+    TEST_ASSERT_EQUAL_PTR(binary + 3, str_find_any(binary, 5, "\xff\0", 2));
+    TEST_ASSERT_EQUAL_PTR(binary + 4, str_find_any(binary, 5, "\xff", 1));
+}
+
+static void assert_trim(const char *input, const char *expected)
+{
+    size_t len;
+    const char *trimmed = str_trim(input, strlen(input), &len);
+    TEST_ASSERT_EQUAL(strlen(expected), len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, trimmed, len);
+}
+
+void test_str_trim(void)
+{
+    assert_trim("  value\r\n", "value");
+    assert_trim("\tkey value\v\f", "key value");
+    assert_trim("value", "value");
+    assert_trim(" \t\r\n ", "");
+    assert_trim("", "");
+}
+
+void test_str_split__returns_all_tokens(void)
+{
+    const char *line = "a,b;;c,";
+    const char *expected[] = {"a", "b", "", "c", ""};
+    StrSplit split;
+    str_split_init(&split, line, strlen(line), ",;", 2);
+
+    const char *token;
+    size_t token_len;
+    size_t count = 0;
+    while(str_split_next(&split, &token, &token_len)) {
+        TEST_ASSERT_TRUE(count < 5);
+        TEST_ASSERT_EQUAL(strlen(expected[count]), token_len);
+        TEST_ASSERT_EQUAL_MEMORY(expected[count], token, token_len);
+        count++;
+    }
+    TEST_ASSERT_EQUAL(5, count);
+    TEST_ASSERT_FALSE(str_split_next(&split, &token, &token_len));
+
+    // an empty input has one empty token
+    str_split_init(&split, "", 0, ",", 1);
+    TEST_ASSERT_TRUE(str_split_next(&split, &token, &token_len));
+    TEST_ASSERT_EQUAL(0, token_len);
+    TEST_ASSERT_FALSE(str_split_next(&split, &token, &token_len));
+
+    // only the first n characters are split
+    str_split_init(&split, "key: value\r\nnext", 10, ":", 1);
+    TEST_ASSERT_TRUE(str_split_next(&split, &token, &token_len));
+    TEST_ASSERT_EQUAL_MEMORY("key", token, token_len);
+    TEST_ASSERT_TRUE(str_split_next(&split, &token, &token_len));
+    TEST_ASSERT_EQUAL(6, token_len);
+    TEST_ASSERT_EQUAL_MEMORY(" value", token, token_len);
+    TEST_ASSERT_FALSE(str_split_next(&split, &token, &token_len));
+}
+
+// reference: decode every code point and check its value
+static bool reference_utf8_valid(const unsigned char *s, size_t n)
+{
+    size_t i = 0;
+    while(i < n) {
+        const unsigned char c = s[i];
+        size_t len;
+        uint32_t cp;
+        uint32_t min_cp;
+        if(c < 0x80) {
+            i++;
+            continue;
+        } else if((c & 0xE0) == 0xC0) {
+            len = 2; cp = c & 0x1F; min_cp = 0x80;
+        } else if((c & 0xF0) == 0xE0) {
+            len = 3; cp = c & 0x0F; min_cp = 0x800;
+        } else if((c & 0xF8) == 0xF0) {
+            len = 4; cp = c & 0x07; min_cp = 0x10000;
+        } else {
+            return false;
+        }
+        if((i + len) > n) {
+            return false;
+        }
+        for(size_t j=1; j<len; j++) {
+            if((s[i + j] & 0xC0) != 0x80) {
+                return false;
+            }
+            cp = (cp << 6) | (s[i + j] & 0x3F);
+        }
+        if((cp < min_cp) || (cp > 0x10FFFF)
+                || ((cp >= 0xD800) && (cp <= 0xDFFF))) {
+            return false;
+        }
+        i+= len;
+    }
+    return true;
+}
+
+// validate in one go, and split into two spans at every position
+static void assert_utf8_like_reference(const char *str, size_t n)
+{
+    const bool expected = reference_utf8_valid((const unsigned char *)str, n);
+    TEST_ASSERT_EQUAL(expected, str_utf8_validate(str, n));
+
+    for(size_t split=0; split<=n; split+= (n > 40) ? 7 : 1) {
+        Utf8Validator v;
+        str_utf8_validator_init(&v);
+        str_utf8_validator_update(&v, str, split);
+        str_utf8_validator_update(&v, str + split, n - split);
+        TEST_ASSERT_EQUAL(expected, str_utf8_validator_finish(&v));
+    }
+}
+
+void test_str_utf8_validate__matches_reference(void)
+{
+    TEST_ASSERT_TRUE(str_utf8_validate("", 0));
+    TEST_ASSERT_TRUE(str_utf8_validate("caf\xc3\xa9 \xe2\x82\xac "
+                "\xf0\x9f\x98\x80", 14));
+    TEST_ASSERT_FALSE(str_utf8_validate("\xc0\xaf", 2));        // overlong
+    TEST_ASSERT_FALSE(str_utf8_validate("\xed\xa0\x80", 3));    // surrogate
+    TEST_ASSERT_FALSE(str_utf8_validate("\xf4\x90\x80\x80", 4)); // > U+10FFFF
+    TEST_ASSERT_FALSE(str_utf8_validate("\xe2\x82", 2));        // incomplete
+    TEST_ASSERT_FALSE(str_utf8_validate("\x80", 1));             // stray
+
+    // every 1 and 2 byte input, at every offset in a block
+    char buffer[80];
+    for(uint32_t i=0; i<0x10000; i++) {
+        const size_t offset = i % 33;
+        memset(buffer, 'a', sizeof(buffer));
+        buffer[offset] = i >> 8;
+        buffer[offset + 1] = i;
+        assert_utf8_like_reference(buffer + offset, 1);
+        assert_utf8_like_reference(buffer, offset + 2);
+    }
+
+    // random mixes of valid sequences and a few random bytes
+    const char *pieces[] = {"a", "Z", "\xc2\x80", "\xdf\xbf", "\xe0\xa0\x80",
+        "\xed\x9f\xbf", "\xee\x80\x80", "\xef\xbf\xbf",
+        "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf", "\xf3\xbf\xbf\xbf"};
+    const size_t piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    for(int round=0; round<20000; round++) {
+        size_t len = 0;
+        const size_t target = rand_next() % (sizeof(buffer) - 4);
+        while(len < target) {
+            const char *piece = pieces[rand_next() % piece_count];
+            memcpy(buffer + len, piece, strlen(piece));
+            len+= strlen(piece);
+        }
+        if((round % 2) && len) {
+            buffer[rand_next() % len] = rand_next();
+        }
+        assert_utf8_like_reference(buffer, len);
+    }
+}
+
+void test_str_is_ascii(void)
+{
+    char buffer[100];
+    memset(buffer, 'x', sizeof(buffer));
+    for(size_t n=0; n<=sizeof(buffer); n++) {
+        TEST_ASSERT_TRUE(str_is_ascii(buffer, n));
+    }
+    for(size_t pos=0; pos<sizeof(buffer); pos++) {
+        buffer[pos] = (char)0x80;
+        TEST_ASSERT_FALSE(str_is_ascii(buffer, sizeof(buffer)));
+        TEST_ASSERT_TRUE(str_is_ascii(buffer, pos));
+        buffer[pos] = 'x';
+    }
+}
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+void test_str__benchmark(void)
+{
+    enum {SIZE = 4096, ROUNDS = 20000};
+    static char a[SIZE + 1];
+    static char b[SIZE + 1];
+    const char *words = "Content-Length Keep-Alive x-request-id ";
+    for(size_t i=0; i<SIZE; i++) {
+        a[i] = words[i % strlen(words)];
+        b[i] = toupper(a[i]);
+    }
+    a[SIZE] = '\0';
+    b[SIZE] = '\0';
+    a[SIZE - 1] = '\n';
+    int sink = 0;
+    // read every round, so calls are not hoisted out of the loops
+    volatile size_t size = SIZE;
+
+    clock_t start = clock();
+    for(int r=0; r<ROUNDS; r++) {
+        sink+= strncasecmp(a, b, size);
+    }
+    const double libc_cmp = seconds_since(start);
+    start = clock();
+    for(int r=0; r<ROUNDS; r++) {
+        sink+= str_casecmp_n(a, b, size);
+    }
+    const double cmp = seconds_since(start);
+
+    start = clock();
+    for(int r=0; r<ROUNDS; r++) {
+        sink+= strpbrk(a + SIZE - size, "\n;#") - a;
+    }
+    const double libc_find = seconds_since(start);
+    start = clock();
+    for(int r=0; r<ROUNDS; r++) {
+        sink+= str_find_any(a, size, "\n;#", 3) - a;
+    }
+    const double find = seconds_since(start);
+
+    start = clock();
+    for(int r=0; r<ROUNDS; r++) {
+        const char *token = b;
+        const char *end = b + size;
+        const char *delimiter;
+        while((delimiter = memchr(token, ' ', end - token))) {
+            sink+= token[0];
+            token = delimiter + 1;
+        }
+        sink+= token[0];
+    }
+    const double libc_split = seconds_since(start);
+    start = clock();
+    for(int r=0; r<ROUNDS; r++) {
+        StrSplit split;
+        str_split_init(&split, b, size, " ", 1);
+        const char *token;
+        size_t token_len;
+        while(str_split_next(&split, &token, &token_len)) {
+            sink+= token[0];
+        }
+    }
+    const double split = seconds_since(start);
+
+    const double bytes = (double)SIZE * ROUNDS;
+    printf("casecmp: %.2f ns/byte (strncasecmp %.2f)\n",
+            cmp * 1e9 / bytes, libc_cmp * 1e9 / bytes);
+    printf("find_any: %.2f ns/byte (strpbrk %.2f)\n",
+            find * 1e9 / bytes, libc_find * 1e9 / bytes);
+    printf("split: %.2f ns/byte (memchr loop %.2f)\n",
+            split * 1e9 / bytes, libc_split * 1e9 / bytes);
+    TEST_ASSERT_TRUE(sink != 0x12345678);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
     RUN_TEST(test_str_toupper);
+    RUN_TEST(test_str_tolower);
+    RUN_TEST(test_str_toupper_n__matches_toupper);
+    RUN_TEST(test_str_toupper_n__ignores_terminator);
+    RUN_TEST(test_str_casecmp_n__matches_strncasecmp);
+    RUN_TEST(test_str_find_any__finds_first_delimiter);
+    RUN_TEST(test_str_trim);
+    RUN_TEST(test_str_split__returns_all_tokens);
+    RUN_TEST(test_str_utf8_validate__matches_reference);
+    RUN_TEST(test_str_is_ascii);
+#if RUN_STR_BENCHMARK
+    RUN_TEST(test_str__benchmark);
+#endif
     UNITY_END();
 
 
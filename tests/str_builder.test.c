@@ -0,0 +1,99 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "str_builder.h"
+#include "unity.h"
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+void assert(bool sane)
+{
+    TEST_ASSERT_MESSAGE(sane, "Assertion failed!");
+}
+
+void test_str_builder__appends_match_snprintf(void)
+{
+    char line[128];
+    char expected[128];
+    StrBuilder sb;
+    str_builder_init(&sb, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("", str_builder_str(&sb));
+    TEST_ASSERT_EQUAL(0, str_builder_len(&sb));
+
+    TEST_ASSERT_TRUE(str_builder_append_str(&sb, "id="));
+    TEST_ASSERT_TRUE(str_builder_append_hex(&sb, 0xBEEF, 8, false));
+    TEST_ASSERT_TRUE(str_builder_append_strn(&sb, " count=xyz", 7));
+    TEST_ASSERT_TRUE(str_builder_append_int(&sb, -9223372036854775807LL));
+    TEST_ASSERT_TRUE(str_builder_append_char(&sb, ' '));
+    TEST_ASSERT_TRUE(str_builder_append_float(&sb, 3.14159f, 3));
+    TEST_ASSERT_TRUE(str_builder_append_hex(&sb, 0xABC, 0, true));
+
+    const int len = snprintf(expected, sizeof(expected), "id=%08x count=%lld "
+            "%.3f%X", 0xBEEF, -9223372036854775807LL, 3.14159f, 0xABC);
+    TEST_ASSERT_EQUAL_STRING(expected, str_builder_str(&sb));
+    TEST_ASSERT_EQUAL(len, str_builder_len(&sb));
+    TEST_ASSERT_FALSE(str_builder_is_truncated(&sb));
+
+    // start over
+    str_builder_reset(&sb);
+    TEST_ASSERT_TRUE(str_builder_append_int(&sb, 0));
+    TEST_ASSERT_EQUAL_STRING("0", str_builder_str(&sb));
+    TEST_ASSERT_EQUAL(1, str_builder_len(&sb));
+}
+
+void test_str_builder__truncation__is_sticky(void)
+{
+    char line[8];
+    memset(line, 0x33, sizeof(line));
+    StrBuilder sb;
+    str_builder_init(&sb, line, sizeof(line));
+
+    TEST_ASSERT_TRUE(str_builder_append_str(&sb, "abc"));
+    TEST_ASSERT_FALSE(str_builder_append_int(&sb, 123456));
+    TEST_ASSERT_EQUAL_STRING("abc1234", str_builder_str(&sb));
+    TEST_ASSERT_EQUAL(7, str_builder_len(&sb));
+    TEST_ASSERT_TRUE(str_builder_is_truncated(&sb));
+
+    // nothing is appended anymore, even if it would fit
+    TEST_ASSERT_FALSE(str_builder_append_str(&sb, ""));
+    TEST_ASSERT_FALSE(str_builder_append_char(&sb, 'x'));
+    TEST_ASSERT_EQUAL_STRING("abc1234", str_builder_str(&sb));
+
+    // every append type truncates the same way
+    str_builder_reset(&sb);
+    TEST_ASSERT_FALSE(str_builder_is_truncated(&sb));
+    TEST_ASSERT_TRUE(str_builder_append_str(&sb, "abcdef"));
+    TEST_ASSERT_FALSE(str_builder_append_float(&sb, 1.5f, 1));
+    TEST_ASSERT_EQUAL_STRING("abcdef1", str_builder_str(&sb));
+
+    str_builder_reset(&sb);
+    TEST_ASSERT_FALSE(str_builder_append_hex(&sb, 0x12345678, 10, true));
+    TEST_ASSERT_EQUAL_STRING("0012345", str_builder_str(&sb));
+
+    str_builder_reset(&sb);
+    TEST_ASSERT_TRUE(str_builder_append_str(&sb, "abcdefg"));
+    TEST_ASSERT_FALSE(str_builder_is_truncated(&sb));
+    TEST_ASSERT_FALSE(str_builder_append_char(&sb, 'h'));
+    TEST_ASSERT_EQUAL_STRING("abcdefg", str_builder_str(&sb));
+
+    // the only space is for the terminator
+    char empty[1];
+    str_builder_init(&sb, empty, sizeof(empty));
+    TEST_ASSERT_TRUE(str_builder_append_str(&sb, ""));
+    TEST_ASSERT_FALSE(str_builder_append_int(&sb, 1));
+    TEST_ASSERT_EQUAL_STRING("", str_builder_str(&sb));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_str_builder__appends_match_snprintf);
+    RUN_TEST(test_str_builder__truncation__is_sticky);
+
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "str_intern.h"
+#include "unity.h"
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+void assert(bool sane)
+{
+    TEST_ASSERT_MESSAGE(sane, "Assertion failed!");
+}
+
+#define SLOT_COUNT  (4096)
+#define MAX_COUNT   (2000)
+#define POOL_SIZE   (64 * 1024)
+
+static StrInternSlot g_slots[SLOT_COUNT];
+static StrInternEntry g_entries[MAX_COUNT];
+static char g_pool[POOL_SIZE];
+
+static uint32_t intern_str(StrIntern *table, const char *str)
+{
+    return str_intern(table, str, strlen(str));
+}
+
+void test_str_intern__same_string__same_id(void)
+{
+    StrIntern table;
+    str_intern_init(&table, g_slots, SLOT_COUNT, g_entries, MAX_COUNT,
+            g_pool, POOL_SIZE, false);
+    TEST_ASSERT_EQUAL(0, str_intern_count(&table));
+
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "cpu.load"));
+    TEST_ASSERT_EQUAL(1, intern_str(&table, "cpu.temp"));
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "cpu.load"));
+    TEST_ASSERT_EQUAL(2, intern_str(&table, "CPU.load"));
+    TEST_ASSERT_EQUAL(3, intern_str(&table, ""));
+    TEST_ASSERT_EQUAL(3, intern_str(&table, ""));
+    // input does not have to be null-terminated
+    TEST_ASSERT_EQUAL(1, str_intern(&table, "cpu.temperature", 8));
+    TEST_ASSERT_EQUAL(4, str_intern(&table, "cpu.load\0x", 10));
+    TEST_ASSERT_EQUAL(5, str_intern_count(&table));
+
+    size_t len;
+    TEST_ASSERT_EQUAL_STRING("cpu.temp", str_intern_get(&table, 1, &len));
+    TEST_ASSERT_EQUAL(8, len);
+    TEST_ASSERT_EQUAL_STRING("", str_intern_get(&table, 3, NULL));
+    TEST_ASSERT_EQUAL_MEMORY("cpu.load\0x", str_intern_get(&table, 4, &len),
+            10);
+    TEST_ASSERT_EQUAL(10, len);
+    TEST_ASSERT_NULL(str_intern_get(&table, 5, NULL));
+
+    TEST_ASSERT_EQUAL(2, str_intern_find(&table, "CPU.load", 8));
+    TEST_ASSERT_EQUAL(STR_INTERN_NONE, str_intern_find(&table, "cpu", 3));
+    TEST_ASSERT_EQUAL(5, str_intern_count(&table));
+
+    // IDs start from 0 again
+    str_intern_clear(&table);
+    TEST_ASSERT_EQUAL(0, str_intern_count(&table));
+    TEST_ASSERT_EQUAL(STR_INTERN_NONE, str_intern_find(&table, "cpu.load", 8));
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "cpu.temp"));
+}
+
+void test_str_intern__ignore_case(void)
+{
+    StrIntern table;
+    str_intern_init(&table, g_slots, SLOT_COUNT, g_entries, MAX_COUNT,
+            g_pool, POOL_SIZE, true);
+
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "Content-Type"));
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "content-type"));
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "CONTENT-TYPE"));
+    TEST_ASSERT_EQUAL(1, intern_str(&table, "Content-Length"));
+    TEST_ASSERT_EQUAL(0, str_intern_find(&table, "cOnTeNt-TyPe", 12));
+
+    // the first spelling is stored
+    TEST_ASSERT_EQUAL_STRING("Content-Type", str_intern_get(&table, 0, NULL));
+
+    // longer than one folded chunk, differing only in case at the end
+    char long_a[200];
+    char long_b[200];
+    memset(long_a, 'k', sizeof(long_a));
+    memset(long_b, 'K', sizeof(long_b));
+    long_b[sizeof(long_b) - 1] = 'k';
+    TEST_ASSERT_EQUAL(2, str_intern(&table, long_a, sizeof(long_a)));
+    TEST_ASSERT_EQUAL(2, str_intern(&table, long_b, sizeof(long_b)));
+    long_b[sizeof(long_b) - 1] = 'x';
+    TEST_ASSERT_EQUAL(3, str_intern(&table, long_b, sizeof(long_b)));
+}
+
+void test_str_intern__many_strings__stable_ids(void)
+{
+    StrIntern table;
+    str_intern_init(&table, g_slots, SLOT_COUNT, g_entries, MAX_COUNT,
+            g_pool, POOL_SIZE, false);
+
+    char name[32];
+    for(uint32_t i=0; i<MAX_COUNT; i++) {
+        snprintf(name, sizeof(name), "metric.%u.value", (unsigned int)i);
+        TEST_ASSERT_EQUAL(i, intern_str(&table, name));
+    }
+    for(uint32_t i=0; i<MAX_COUNT; i++) {
+        snprintf(name, sizeof(name), "metric.%u.value", (unsigned int)i);
+        TEST_ASSERT_EQUAL(i, intern_str(&table, name));
+        TEST_ASSERT_EQUAL_STRING(name, str_intern_get(&table, i, NULL));
+    }
+
+    // the table is full: known strings still work, new ones do not
+    TEST_ASSERT_EQUAL(STR_INTERN_NONE, intern_str(&table, "new"));
+    TEST_ASSERT_EQUAL(7, intern_str(&table, "metric.7.value"));
+    TEST_ASSERT_EQUAL(MAX_COUNT, str_intern_count(&table));
+}
+
+void test_str_intern__pool_full__returns_none(void)
+{
+    StrInternSlot slots[8];
+    StrInternEntry entries[4];
+    char pool[10];
+    StrIntern table;
+    str_intern_init(&table, slots, 8, entries, 4, pool, sizeof(pool), false);
+
+    // "abcd\0" + "efgh\0" fills the pool exactly
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "abcd"));
+    TEST_ASSERT_EQUAL(1, intern_str(&table, "efgh"));
+    TEST_ASSERT_EQUAL(STR_INTERN_NONE, intern_str(&table, ""));
+    TEST_ASSERT_EQUAL(0, intern_str(&table, "abcd"));
+    TEST_ASSERT_EQUAL(2, str_intern_count(&table));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_str_intern__same_string__same_id);
+    RUN_TEST(test_str_intern__ignore_case);
+    RUN_TEST(test_str_intern__many_strings__stable_ids);
+    RUN_TEST(test_str_intern__pool_full__returns_none);
+
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "strn2f.h"
+#include "f2strn.h"
+#include "unity.h"
+
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+static bool same_double(double a, double b)
+{
+    return !memcmp(&a, &b, sizeof(a)) || (isnan(a) && isnan(b));
+}
+
+static bool same_float(float a, float b)
+{
+    return !memcmp(&a, &b, sizeof(a)) || (isnan(a) && isnan(b));
+}
+
+// compare with strtod() / strtof(): value and consumed length
+static void assert_like_strtod(const char *str)
+{
+    char *end;
+    const double ref_d = strtod(str, &end);
+    const size_t ref_len_d = end - str;
+    const float ref_f = strtof(str, &end);
+    const size_t ref_len_f = end - str;
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "input: \"%s\"", str);
+
+    double d;
+    TEST_ASSERT_EQUAL_MESSAGE(ref_len_d, strn2d(str, strlen(str), &d), msg);
+    TEST_ASSERT_TRUE_MESSAGE(same_double(ref_d, d), msg);
+
+    float f;
+    TEST_ASSERT_EQUAL_MESSAGE(ref_len_f, strn2f(str, strlen(str), &f), msg);
+    TEST_ASSERT_TRUE_MESSAGE(same_float(ref_f, f), msg);
+}
+
+void test_strn2f__parses_like_strtod(void)
+{
+    const char *inputs[] = {"0", "-0", "1", "+1.5", "-2.5e3", "0.1", ".5",
+        "5.", "1e-7", "1E+21", "123.456abc", "1e", "1e+", "1.5e-x",
+        "000123.4500", "0.000000000000000000000000000000000001",
+        "3.4028235e38", "3.4028236e38", "1e39", "1e-46", "1.4e-45",
+        "1.7976931348623157e308", "1.8e308", "4.9e-324", "2e-324",
+        "2.2250738585072011e-308", "inf", "-Infinity", "INFINITE",
+        "nan", "-NaN", "1e99999999999", "1e-99999999999",
+        "12345678901234567890123", "0.1000000000000000055511151231257827"};
+
+    for(size_t i=0; i<sizeof(inputs)/sizeof(inputs[0]); i++) {
+        assert_like_strtod(inputs[i]);
+    }
+}
+
+void test_strn2f__no_number__returns_zero(void)
+{
+    const char *inputs[] = {"", "-", "+", ".", "-.", "e5", "abc", " 1",
+        "in", "+-1"};
+
+    for(size_t i=0; i<sizeof(inputs)/sizeof(inputs[0]); i++) {
+        float f = 1.0f;
+        TEST_ASSERT_EQUAL(0, strn2f(inputs[i], strlen(inputs[i]), &f));
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, f);
+    }
+}
+
+void test_strn2f__reads_at_most_n_characters(void)
+{
+    // not null-terminated
+    const char data[] = {'1', '.', '2', '5', 'e', '1', '0'};
+    float f;
+    double d;
+
+    TEST_ASSERT_EQUAL(7, strn2d(data, 7, &d));
+    TEST_ASSERT_EQUAL_DOUBLE(1.25e10, d);
+    TEST_ASSERT_EQUAL(4, strn2f(data, 5, &f));
+    TEST_ASSERT_EQUAL_FLOAT(1.25f, f);
+    TEST_ASSERT_EQUAL(3, strn2f(data, 3, &f));
+    TEST_ASSERT_EQUAL_FLOAT(1.2f, f);
+    TEST_ASSERT_EQUAL(0, strn2f(data, 0, &f));
+
+    const char inf[] = {'i', 'n', 'f', 'i', 'n'};
+    TEST_ASSERT_EQUAL(3, strn2f(inf, sizeof(inf), &f));
+    TEST_ASSERT_TRUE(isinf(f));
+}
+
+// Exact decimal digits of 1.5 * a, followed by 'tail', as
+// "0.<digits><tail>e<exponent>". For a = k * 2^-1074 with odd k, this is
+// exactly halfway between two subnormals.
+static void halfway_digits(char *str, size_t size, double a, const char *tail)
+{
+    // a = d.ddd...e<x> exactly, or 0.<digits> * 10^(x+1)
+    char digits[800];
+    snprintf(digits, sizeof(digits), "%.780e", a);
+    char *e = strchr(digits, 'e');
+    const int exponent = atoi(e + 1) + 1;
+    *e = '\0';
+    memmove(digits + 1, digits + 2, strlen(digits + 2) + 1);
+
+    // times 1.5: the digits times 15, with one more digit
+    const size_t len = strlen(digits);
+    char result[sizeof(digits) + 1];
+    unsigned int carry = 0;
+    result[len + 1] = '\0';
+    for(size_t i=len; i>0; i--) {
+        const unsigned int v = ((digits[i-1] - '0') * 15) + carry;
+        result[i] = '0' + (v % 10);
+        carry = v / 10;
+    }
+    result[0] = '0' + carry;
+    snprintf(str, size, "0.%s%se%d", result, tail, exponent);
+}
+
+void test_strn2d__long_and_halfway_inputs(void)
+{
+    char str[1200];
+
+    // 2^53 + 1 is halfway: ties to even, any more digits round up
+    assert_like_strtod("9007199254740993");
+    assert_like_strtod("9007199254740993.000000000000000000000000001");
+    assert_like_strtod("9007199254740992.999999999999999999999999999");
+
+    // exactly halfway between subnormals (751 significant digits),
+    // then just above it
+    halfway_digits(str, sizeof(str), 0x1p-1074, "");
+    assert_like_strtod(str);
+    halfway_digits(str, sizeof(str), 0x1.8p-1073, "");
+    assert_like_strtod(str);
+    halfway_digits(str, sizeof(str), 0x1.8p-1073, "00001");
+    assert_like_strtod(str);
+
+    // more digits than the exact fallback keeps
+    memset(str, '9', 1100);
+    str[0] = '0';
+    str[1] = '.';
+    str[1100] = '\0';
+    assert_like_strtod(str);
+}
+
+void test_strn2f__round_trips_f2strn(void)
+{
+    char string[64];
+    for(uint32_t i=0; i<100000; i++) {
+        // floats: shortest and 9 significant digits read back exactly
+        union {
+            float val;
+            uint32_t bits;
+        } f;
+        f.bits = i * 42953u;
+        float parsed_f;
+        size_t len = f2strn_shortest(f.val, string, sizeof(string));
+        TEST_ASSERT_EQUAL(len, strn2f(string, len, &parsed_f));
+        TEST_ASSERT_TRUE(same_float(f.val, parsed_f));
+
+        len = f2strn_exp(f.val, string, sizeof(string), 8);
+        TEST_ASSERT_EQUAL(len, strn2f(string, len, &parsed_f));
+        TEST_ASSERT_TRUE(same_float(f.val, parsed_f));
+
+        // doubles: shortest and 17 significant digits
+        union {
+            double val;
+            uint64_t bits;
+        } d;
+        d.bits = i * 0x9e3779b97f4a7c15ULL;
+        double parsed_d;
+        len = d2strn_shortest(d.val, string, sizeof(string));
+        TEST_ASSERT_EQUAL(len, strn2d(string, len, &parsed_d));
+        TEST_ASSERT_TRUE(same_double(d.val, parsed_d));
+
+        len = d2strn_exp(d.val, string, sizeof(string), 16);
+        TEST_ASSERT_EQUAL(len, strn2d(string, len, &parsed_d));
+        TEST_ASSERT_TRUE(same_double(d.val, parsed_d));
+    }
+
+    // fixed decimals: the same as strtof() on the same text
+    for(int i=-2000; i<2000; i++) {
+        f2strn_fixed(i * 0.731f, string, sizeof(string), 3);
+        assert_like_strtod(string);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_strn2f__parses_like_strtod);
+    RUN_TEST(test_strn2f__no_number__returns_zero);
+    RUN_TEST(test_strn2f__reads_at_most_n_characters);
+    RUN_TEST(test_strn2d__long_and_halfway_inputs);
+    RUN_TEST(test_strn2f__round_trips_f2strn);
+    return UNITY_END();
+}
@@ -0,0 +1,161 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "strn_to_int.h"
+#include "unity.h"
+
+
+// Unity boilerplate
+void setUp(void){}
+void tearDown(void){}
+
+// compare with strtoll(): value and consumed length
+static void assert_like_strtoll(const char *str)
+{
+    char msg[128];
+    snprintf(msg, sizeof(msg), "input: \"%s\"", str);
+
+    char *end;
+    errno = 0;
+    const long long ref = strtoll(str, &end, 10);
+    const size_t ref_len = (errno == ERANGE) ? 0 : (size_t)(end - str);
+
+    int64_t result = 12345;
+    TEST_ASSERT_EQUAL_MESSAGE(ref_len,
+            strn_to_i64(str, strlen(str), &result), msg);
+    TEST_ASSERT_TRUE_MESSAGE(ref == result, msg);
+}
+
+static void assert_like_strtoull(const char *str)
+{
+    char msg[128];
+    snprintf(msg, sizeof(msg), "input: \"%s\"", str);
+
+    char *end;
+    errno = 0;
+    const unsigned long long ref = strtoull(str, &end, 10);
+    const size_t ref_len = (errno == ERANGE) ? 0 : (size_t)(end - str);
+
+    uint64_t result = 12345;
+    TEST_ASSERT_EQUAL_MESSAGE(ref_len,
+            strn_to_u64(str, strlen(str), &result), msg);
+    TEST_ASSERT_TRUE_MESSAGE(ref == result, msg);
+}
+
+void test_strn_to_int__parses_like_strtoll(void)
+{
+    const char *inputs[] = {"0", "-0", "+0", "7", "-7", "42abc",
+        "12345678", "123456789", "1234567x9", "-12345678901234567",
+        "0000000000000000000000000000001", "00000000", "99999999",
+        "9223372036854775807", "9223372036854775808",
+        "-9223372036854775808", "-9223372036854775809",
+        "18446744073709551615", "18446744073709551616",
+        "99999999999999999999", "123456789012345678901234567890",
+        "1234567:", "1234567/", "12345678:9"};
+
+    for(size_t i=0; i<sizeof(inputs)/sizeof(inputs[0]); i++) {
+        assert_like_strtoll(inputs[i]);
+        if(inputs[i][0] != '-') {
+            assert_like_strtoull(inputs[i]);
+        }
+    }
+
+    // random values of every length, with and without trailing text
+    unsigned long long x = 0x9E3779B97F4A7C15ULL;
+    for(int i=0; i<100000; i++) {
+        x^= x << 13;
+        x^= x >> 7;
+        x^= x << 17;
+        char str[32];
+        snprintf(str, sizeof(str), "%lld%s", (long long)(x >> (i % 64)),
+                (i & 1) ? "" : ",1");
+        assert_like_strtoll(str);
+        snprintf(str, sizeof(str), "%llu%s", x >> (i % 64),
+                (i & 1) ? "" : " ");
+        assert_like_strtoull(str);
+    }
+}
+
+void test_strn_to_int__no_number__returns_zero(void)
+{
+    const char *inputs[] = {"", "-", "+", "x1", " 1", "--1", "+-1",
+        "x10", "\t"};
+    for(size_t i=0; i<sizeof(inputs)/sizeof(inputs[0]); i++) {
+        int64_t result = 12345;
+        TEST_ASSERT_EQUAL(0, strn_to_i64(inputs[i], strlen(inputs[i]),
+                    &result));
+        TEST_ASSERT_EQUAL(0, result);
+
+        uint64_t uresult = 12345;
+        TEST_ASSERT_EQUAL(0, strn_to_u64(inputs[i], strlen(inputs[i]),
+                    &uresult));
+        TEST_ASSERT_EQUAL(0, uresult);
+    }
+
+    // unsigned values have no minus sign
+    uint64_t uresult = 12345;
+    TEST_ASSERT_EQUAL(0, strn_to_u64("-1", 2, &uresult));
+    TEST_ASSERT_EQUAL(0, uresult);
+}
+
+void test_strn_to_int__overflow__saturates(void)
+{
+    int64_t result;
+    TEST_ASSERT_EQUAL(0, strn_to_i64("9223372036854775808", 19, &result));
+    TEST_ASSERT_TRUE(result == INT64_MAX);
+    TEST_ASSERT_EQUAL(0, strn_to_i64("-9223372036854775809", 20, &result));
+    TEST_ASSERT_TRUE(result == INT64_MIN);
+    TEST_ASSERT_EQUAL(0, strn_to_i64("-99999999999999999999999", 24,
+                &result));
+    TEST_ASSERT_TRUE(result == INT64_MIN);
+
+    uint64_t uresult;
+    TEST_ASSERT_EQUAL(0, strn_to_u64("18446744073709551616", 20, &uresult));
+    TEST_ASSERT_TRUE(uresult == UINT64_MAX);
+    TEST_ASSERT_EQUAL(20, strn_to_u64("18446744073709551615", 20, &uresult));
+    TEST_ASSERT_TRUE(uresult == UINT64_MAX);
+}
+
+void test_strn_to_int__reads_at_most_n_characters(void)
+{
+    // exactly sized buffers without terminator: ASan catches overreads
+    const char digits[] = "123456789012345678";
+    for(size_t n=0; n<=18; n++) {
+        char *str = malloc(n ? n : 1);
+        memcpy(str, digits, n);
+
+        int64_t result;
+        uint64_t expected = 0;
+        for(size_t i=0; i<n; i++) {
+            expected = (expected * 10) + (digits[i] - '0');
+        }
+        TEST_ASSERT_EQUAL(n, strn_to_i64(str, n, &result));
+        TEST_ASSERT_TRUE((uint64_t)result == expected);
+
+        uint64_t uresult;
+        TEST_ASSERT_EQUAL(n, strn_to_u64(str, n, &uresult));
+        TEST_ASSERT_TRUE(uresult == expected);
+        free(str);
+    }
+
+    // the rest of the string is ignored
+    int64_t result;
+    TEST_ASSERT_EQUAL(3, strn_to_i64("-12345678", 3, &result));
+    TEST_ASSERT_EQUAL(-12, result);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_strn_to_int__parses_like_strtoll);
+    RUN_TEST(test_strn_to_int__no_number__returns_zero);
+    RUN_TEST(test_strn_to_int__overflow__saturates);
+    RUN_TEST(test_strn_to_int__reads_at_most_n_characters);
+
+    UNITY_END();
+
+    return 0;
+}